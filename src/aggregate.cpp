@@ -0,0 +1,548 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    aggregate.cpp -- Implementation of temporal aggregation functions
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+using namespace std;
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include "global.h"
+#include "aggregate.h"
+#include "model.h"
+#include "read.h"
+#include "index.h"
+
+// Enumerates the steps in 'length' down to level 'depth', in the same order as Step2Pos
+void ListSteps(const Step& length, const int depth, Step current, const int level, vector<Step>& output) {
+	for (int k = 1; k <= length[level]; ++k) {
+		current[level] = k;
+		output.push_back(current);
+		if (level < depth) ListSteps(length, depth, current, level+1, output);
+	}
+}
+
+// Is the property a finite number?
+bool AggNumeric(const string& value) {
+	char* end;
+	double output = strtod(value.c_str(), &end);
+	return (end != value.c_str()) && (*end == '\0') && (fabs(output) < 1e20);
+}
+
+// Numeric value of a property, non-numeric and infinite values are ignored
+double AggValue(const string& value) {
+	return AggNumeric(value) ? atof(value.c_str()) : 0;
+}
+
+// Index of the group (all levels before the period level) that a step belongs to
+int AggGroup(const Step& mystep, const Step& length, const int p) {
+	int group = 0;
+	for (int k = 0; k < p; ++k)
+		group = group * length[k] + (mystep[k] - 1);
+	return group;
+}
+
+void AggregatePeriods(ModelContext& ctx, vector<MatrixStr*>& data, const vector<int>& num_fields, const char* fileoutput) {
+	int p = ctx.SName.size() - 2, nperiods = ctx.SFullLength[p];
+	Step RepLength = ctx.SFullLength;
+	RepLength[p] = ctx.RepPeriods;
+	
+	// Periods are clustered separately within each group (e.g., each year)
+	vector<Step> Groups(0), TempSteps(0);
+	ListSteps(ctx.SFullLength, p-1, Step(ctx.SName.size(), 0), 0, TempSteps);
+	for (unsigned int i = 0; i < TempSteps.size(); ++i)
+		if (TempSteps[i][p-1] != 0) Groups.push_back(TempSteps[i]);
+	
+	// Each period takes 'span' consecutive columns in the data. The first one (the period
+	// itself) is skipped in the profiles because it may hold values from the previous period
+	Step FirstPeriod = Groups[0];
+	FirstPeriod[p] = 1;
+	int first = Step2Pos(FirstPeriod, ctx.SFullLength);
+	FirstPeriod[p] = 2;
+	int span = Step2Pos(FirstPeriod, ctx.SFullLength) - first;
+	
+	// Each row is normalized with its largest value, so that all profiles have similar weight
+	vector<vector<double> > Scale(data.size());
+	for (unsigned int m = 0; m < data.size(); ++m) {
+		MatrixStr& Matrix = *data[m];
+		Scale[m].assign(Matrix.size(), 0);
+		for (unsigned int r = 0; r < Matrix.size(); ++r) {
+			for (unsigned int g = 0; g < Groups.size(); ++g) {
+				Step Period = Groups[g];
+				Period[p] = 1;
+				int start = num_fields[m] + Step2Pos(Period, ctx.SFullLength);
+				for (int l = start; l < start + nperiods * span; ++l)
+					if ((l - start) % span != 0) Scale[m][r] = max(Scale[m][r], fabs(AggValue(Matrix[r][l])));
+			}
+		}
+	}
+	
+	// Cluster the periods of each group
+	vector<vector<int> > Medoids(Groups.size()), Assign(Groups.size());
+	vector<double> GroupError(Groups.size(), 0);
+	double total_sse = 0, total_var = 0;
+	ctx.PeriodWeight.assign(Groups.size() * ctx.RepPeriods, 0);
+	ctx.PeriodRep.assign(Groups.size() * nperiods, 0);
+	
+	for (unsigned int g = 0; g < Groups.size(); ++g) {
+		// Features are the normalized profiles of all the properties during the period
+		vector<vector<double> > Features(nperiods);
+		for (int d = 0; d < nperiods; ++d) {
+			Step Period = Groups[g];
+			Period[p] = d + 1;
+			for (unsigned int m = 0; m < data.size(); ++m) {
+				MatrixStr& Matrix = *data[m];
+				int start = num_fields[m] + Step2Pos(Period, ctx.SFullLength);
+				for (unsigned int r = 0; r < Matrix.size(); ++r) {
+					if (Scale[m][r] == 0) continue;
+					for (int l = start + 1; l < start + span; ++l)
+						Features[d].push_back(AggValue(Matrix[r][l]) / Scale[m][r]);
+				}
+			}
+		}
+		
+		vector<double> Mean(Features[0].size(), 0);
+		vector<vector<double> > Dist(nperiods, vector<double>(nperiods, 0));
+		for (int i = 0; i < nperiods; ++i) {
+			for (unsigned int f = 0; f < Mean.size(); ++f)
+				Mean[f] += Features[i][f] / nperiods;
+			for (int j = 0; j < i; ++j) {
+				double temp = 0;
+				for (unsigned int f = 0; f < Mean.size(); ++f)
+					temp += (Features[i][f] - Features[j][f]) * (Features[i][f] - Features[j][f]);
+				Dist[i][j] = temp;
+				Dist[j][i] = temp;
+			}
+		}
+		
+		KMedoids(Dist, ctx.RepPeriods, Medoids[g], Assign[g]);
+		
+		// Clustering error relative to the variance of the periods
+		double sse = 0, var = 0;
+		for (int i = 0; i < nperiods; ++i) {
+			sse += Dist[i][Medoids[g][Assign[g][i]]];
+			for (unsigned int f = 0; f < Mean.size(); ++f)
+				var += (Features[i][f] - Mean[f]) * (Features[i][f] - Mean[f]);
+			ctx.PeriodWeight[g * ctx.RepPeriods + Assign[g][i]] += 1;
+			ctx.PeriodRep[g * nperiods + i] = Assign[g][i];
+		}
+		GroupError[g] = (var > 0) ? sse / var : 0;
+		total_sse += sse;
+		total_var += var;
+	}
+	
+	// Rewrite the properties with the columns of the representative periods
+	vector<Step> NewSteps(0);
+	ListSteps(RepLength, ctx.SName.size()-1, Step(ctx.SName.size(), 0), 0, NewSteps);
+	vector<int> OldPos(NewSteps.size(), 0);
+	for (unsigned int i = 0; i < NewSteps.size(); ++i) {
+		Step OldStep = NewSteps[i];
+		if (OldStep[p] != 0)
+			OldStep[p] = Medoids[AggGroup(OldStep, ctx.SLength, p)][OldStep[p] - 1] + 1;
+		OldPos[i] = Step2Pos(OldStep, ctx.SFullLength);
+	}
+	
+	for (unsigned int m = 0; m < data.size(); ++m) {
+		MatrixStr& Matrix = *data[m];
+		for (unsigned int r = 0; r < Matrix.size(); ++r) {
+			VectorStr Values(NewSteps.size() + num_fields[m] + 1);
+			for (int l = 0; l <= num_fields[m]; ++l)
+				Values[l] = Matrix[r][l];
+			for (unsigned int i = 0; i < NewSteps.size(); ++i)
+				Values[num_fields[m] + i + 1] = Matrix[r][num_fields[m] + OldPos[i]];
+			Matrix[r] = Values;
+		}
+	}
+	ctx.SLength = RepLength;
+	
+	// Store the assignment of periods to recover the full time series
+	if (fileoutput != NULL) {
+		ofstream file(fileoutput);
+		file << "% Group, period, representative period, medoid, weight, group error" << endl;
+		for (unsigned int g = 0; g < Groups.size(); ++g) {
+			for (int d = 0; d < nperiods; ++d) {
+				int r = Assign[g][d];
+				file << Step2Str(ctx, Groups[g]) << "," << d+1 << "," << r+1 << "," << Medoids[g][r]+1;
+				file << "," << ctx.PeriodWeight[g * ctx.RepPeriods + r] << "," << GroupError[g] << endl;
+			}
+		}
+		file.close();
+	}
+	
+	int worst = max_element(GroupError.begin(), GroupError.end()) - GroupError.begin();
+	cout << "  " << nperiods << " periods in " << Groups.size() << " groups represented by " << ctx.RepPeriods << " periods each" << endl;
+	cout << "  Clustering error: " << ((total_var > 0) ? 100 * total_sse / total_var : 0) << "% of the variance";
+	cout << " (worst " << Step2Str(ctx, Groups[worst]) << ": " << 100 * GroupError[worst] << "%)" << endl;
+}
+
+void ReadPeriodWeights(ModelContext& ctx, const char* fileinput) {
+	if (ctx.RepPeriods <= 0)
+		return;
+	
+	// One row per original period: group, period, representative period, medoid, weight, error
+	MatrixStr Table = ReadTable(ctx, fileinput);
+	ctx.PeriodWeight.clear();
+	ctx.PeriodRep.clear();
+	int group = -1;
+	for (unsigned int r = 0; r < Table.size(); ++r) {
+		if (Table[r].size() < 5) continue;
+		if ((group < 0) || (Table[r][0] != Table[r-1][0])) {
+			++group;
+			ctx.PeriodWeight.resize((group + 1) * ctx.RepPeriods, 0);
+		}
+		int rep = atoi(Table[r][2].c_str());
+		if ((rep >= 1) && (rep <= ctx.RepPeriods))
+			ctx.PeriodWeight[group * ctx.RepPeriods + rep - 1] = atof(Table[r][4].c_str());
+		ctx.PeriodRep.push_back(rep - 1);
+	}
+	
+	if (ctx.PeriodWeight.size() == 0) {
+		ctx.RepPeriods = 0;
+		ctx.PeriodRep.clear();
+		ctx.SLength = ctx.SFullLength;
+	}
+}
+
+vector<string> PeriodValues(const ModelContext& ctx, const Index& idx, const vector<string>& values) {
+	vector<string> output(values);
+	if (ctx.PeriodWeight.size() == 0)
+		return output;
+	
+	// Weight of each output column
+	vector<Step> Steps(0);
+	ListSteps(ctx.SLength, ctx.SName.size()-1, Step(ctx.SName.size(), 0), 0, Steps);
+	map<int, double> Weight;
+	for (unsigned int i = 0; i < Steps.size(); ++i)
+		Weight[Step2Col(ctx, Steps[i])] = StepWeight(ctx, Steps[i]);
+	
+	int begin = (idx.size == values.size()) ? 0 : idx.start;
+	for (int i = 0; i < idx.size; ++i) {
+		double w = (Weight.count(idx.column[i]) > 0) ? Weight[idx.column[i]] : 1;
+		if ((w > 0) && (w != 1) && AggNumeric(values[begin + i]))
+			output[begin + i] = ToString<double>(atof(values[begin + i].c_str()) / w);
+	}
+	return output;
+}
+
+// Combines the values of the members of a region according to 'rule' ('sum', 'weight' or 'first')
+string AggCombine(const vector<string>& values, const vector<double>& weights, const string& rule) {
+	bool numeric = true, infinite = false;
+	for (unsigned int i = 0; i < values.size(); ++i) {
+		numeric = numeric && AggNumeric(values[i]);
+		infinite = infinite || (values[i] == "Inf");
+	}
+	
+	if ((rule == "sum") && infinite) return "Inf";
+	if ((rule == "first") || !numeric) return values[0];
+	
+	double output = 0, total = 0;
+	for (unsigned int i = 0; i < values.size(); ++i) {
+		double w = (rule == "sum") ? 1 : weights[i];
+		output += w * AggValue(values[i]);
+		total += w;
+	}
+	if (rule == "sum") return ToString<double>(output);
+	if (total > 0) return ToString<double>(output / total);
+	return AggCombine(values, vector<double>(values.size(), 1), rule);
+}
+
+// Builds a row of 'matrix' for an aggregated element from the rows of its members (-1 if not available)
+bool AggRow(const MatrixStr& matrix, const vector<int>& rows, const string& defvalue, const int num_fields,
+	const vector<vector<double> >& weights, const string& rule, VectorStr& output) {
+	int found = -1;
+	for (unsigned int i = 0; i < rows.size(); ++i)
+		if (rows[i] >= 0) found = rows[i];
+	if (found < 0) return false;
+	
+	output = matrix[found];
+	vector<string> values(rows.size());
+	vector<double> w(rows.size());
+	for (unsigned int l = num_fields; l < output.size(); ++l) {
+		for (unsigned int i = 0; i < rows.size(); ++i) {
+			values[i] = (rows[i] >= 0) ? matrix[rows[i]][l] : defvalue;
+			w[i] = weights[i][l];
+		}
+		output[l] = AggCombine(values, w, rule);
+	}
+	return true;
+}
+
+// Weights for each member and column taken from the property 'matrix' (equal if any of them is not numeric)
+vector<vector<double> > AggWeights(const MatrixStr& matrix, const vector<int>& rows, const string& defvalue, const int size) {
+	vector<vector<double> > output(rows.size(), vector<double>(size, 1));
+	for (int l = 0; l < size; ++l) {
+		bool numeric = true;
+		for (unsigned int i = 0; i < rows.size(); ++i) {
+			string value = (rows[i] >= 0) ? matrix[rows[i]][l] : defvalue;
+			output[i][l] = AggValue(value);
+			numeric = numeric && AggNumeric(value);
+		}
+		if (!numeric)
+			for (unsigned int i = 0; i < rows.size(); ++i) output[i][l] = 1;
+	}
+	return output;
+}
+
+// Share of each member in the sum of 'weights' over all the steps (the first 'num_fields' columns are skipped)
+vector<double> AggShares(const vector<vector<double> >& weights, const int num_fields) {
+	vector<double> output(weights.size(), 0);
+	double total = 0;
+	for (unsigned int i = 0; i < weights.size(); ++i) {
+		for (unsigned int l = num_fields; l < weights[i].size(); ++l)
+			output[i] += weights[i][l];
+		total += output[i];
+	}
+	for (unsigned int i = 0; i < output.size(); ++i)
+		output[i] = (total > 0) ? output[i] / total : 1.0 / output.size();
+	return output;
+}
+
+// Index of a property in NodeProp or ArcProp (the offset is removed)
+int AggProp(const vector<string>& props, const int offset, const string& name) {
+	for (unsigned int t = offset; t < props.size(); ++t)
+		if (props[t] == name) return t - offset;
+	return -1;
+}
+
+// Steps of a node (nodes_Step.csv or its own list)
+string AggStep(const Node& node, const MatrixStr& NStep) {
+	int StepIndex = FindCode(node.Get("ShortCode"), NStep);
+	return (StepIndex >= 0) ? NStep[StepIndex][1] : node.Get("Step");
+}
+
+void AggregateRegions(const ModelContext& ctx, vector<Node>& ListNodes, vector<Arc>& ListArcs, MatrixStr& NStep, vector<MatrixStr>& NVectorProp,
+	vector<MatrixStr>& AVectorProp, const MatrixStr& regions, const char* fileoutput) {
+	int size = Step2Pos(ctx, ctx.SLength) + 1, dropped = 0;
+	map<string, string> Region;
+	for (unsigned int i = 0; i < regions.size(); ++i)
+		Region[regions[i][0]] = regions[i][1];
+	
+	// The members of a region must have the same steps, otherwise it would take the steps of its
+	// first member. Those regions are not aggregated
+	map<string, string> RegionStep;
+	map<string, bool> Mixed;
+	for (unsigned int k = 0; k < ListNodes.size(); ++k) {
+		string code = ListNodes[k].Get("ShortCode");
+		string region = (Region.count(code) > 0) ? Region[code] : code;
+		string step = AggStep(ListNodes[k], NStep);
+		if (RegionStep.count(region) == 0)
+			RegionStep[region] = step;
+		else if (RegionStep[region] != step)
+			Mixed[region] = true;
+	}
+	for (map<string, bool>::iterator it = Mixed.begin(); it != Mixed.end(); ++it) {
+		cout << "\tWarning: Nodes of region '" << it->first << "' have different steps, they are not aggregated" << endl;
+		for (unsigned int i = 0; i < regions.size(); ++i)
+			if (regions[i][1] == it->first) Region.erase(regions[i][0]);
+	}
+	
+	// The mapping is only written if a file is given
+	ofstream file;
+	if (fileoutput != NULL) {
+		file.open(fileoutput);
+		file << "% Aggregated, original, share" << endl;
+	}
+	
+	// Group nodes by region, keeping the position of the first member
+	vector<Node> NewNodes;
+	vector<vector<string> > NodeMembers(0);
+	map<string, int> NodeIndex;
+	for (unsigned int k = 0; k < ListNodes.size(); ++k) {
+		string code = ListNodes[k].Get("ShortCode");
+		string region = (Region.count(code) > 0) ? Region[code] : code;
+		if (NodeIndex.count(region) == 0) {
+			NodeIndex[region] = NewNodes.size();
+			Node TempNode(ctx);
+			TempNode.Set("ShortCode", region);
+			NewNodes.push_back(TempNode);
+			NodeMembers.push_back(vector<string>(0));
+		}
+		NodeMembers[NodeIndex[region]].push_back(code);
+	}
+	
+	int demand = AggProp(ctx.NodeProp, ctx.NodePropOffset, "Demand");
+	int demand_power = AggProp(ctx.NodeProp, ctx.NodePropOffset, "DemandPower");
+	for (unsigned int k = 0; k < NewNodes.size(); ++k) {
+		string region = NewNodes[k].Get("ShortCode");
+		vector<string>& Members = NodeMembers[k];
+		if ((Members.size() == 1) && (Members[0] == region)) continue;
+		
+		int StepIndex = FindCode(Members[0], NStep);
+		if (StepIndex >= 0) {
+			VectorStr TempRow = NStep[StepIndex];
+			TempRow[0] = region;
+			NStep.push_back(TempRow);
+		}
+		NewNodes[k].Set("Step", RegionStep[region]);
+		
+		// Properties are weighted by demand (energy or power)
+		vector<int> rows(Members.size());
+		for (unsigned int i = 0; i < Members.size(); ++i)
+			rows[i] = FindCode(Members[i], NVectorProp[demand]);
+		vector<vector<double> > weights = AggWeights(NVectorProp[demand], rows, ctx.NodeDefault[ctx.NodePropOffset + demand], size + 1);
+		double total = 0;
+		for (unsigned int i = 0; i < Members.size(); ++i)
+			for (int l = 1; l < size + 1; ++l) total += weights[i][l];
+		if (total == 0) {
+			for (unsigned int i = 0; i < Members.size(); ++i)
+				rows[i] = FindCode(Members[i], NVectorProp[demand_power]);
+			weights = AggWeights(NVectorProp[demand_power], rows, ctx.NodeDefault[ctx.NodePropOffset + demand_power], size + 1);
+		}
+		vector<double> shares = AggShares(weights, 1);
+		
+		for (unsigned int t = 0; t < NVectorProp.size(); ++t) {
+			string prop = ctx.NodeProp[ctx.NodePropOffset + t];
+			string rule = ((prop == "Demand") || (prop == "DemandPower") || (prop == "PeakPower")) ? "sum" : "weight";
+			for (unsigned int i = 0; i < Members.size(); ++i)
+				rows[i] = FindCode(Members[i], NVectorProp[t]);
+			VectorStr TempRow;
+			if (AggRow(NVectorProp[t], rows, ctx.NodeDefault[ctx.NodePropOffset + t], 1, weights, rule, TempRow)) {
+				TempRow[0] = region;
+				NVectorProp[t].push_back(TempRow);
+			}
+		}
+		
+		for (unsigned int i = 0; i < Members.size(); ++i)
+			if (file.is_open()) file << region << "," << Members[i] << "," << shares[i] << endl;
+	}
+	
+	// Group arcs by the regions they connect, arcs within a region are dropped
+	vector<Arc> NewArcs;
+	vector<vector<Arc> > ArcMembers(0);
+	map<string, int> ArcIndex;
+	for (unsigned int k = 0; k < ListArcs.size(); ++k) {
+		string from = ListArcs[k].Get("From"), to = ListArcs[k].Get("To");
+		string region_from = (Region.count(from) > 0) ? Region[from] : from;
+		string region_to = (Region.count(to) > 0) ? Region[to] : to;
+		if ((from != to) && (region_from == region_to)) {
+			++dropped;
+			continue;
+		}
+		
+		string key = region_from + "_" + region_to;
+		if (ArcIndex.count(key) == 0) {
+			ArcIndex[key] = NewArcs.size();
+			Arc TempArc(ctx);
+			TempArc.Set("From", region_from);
+			TempArc.Set("To", region_to);
+			NewArcs.push_back(TempArc);
+			ArcMembers.push_back(vector<Arc>());
+		}
+		ArcMembers[ArcIndex[key]].push_back(ListArcs[k]);
+	}
+	
+	int opmax = AggProp(ctx.ArcProp, ctx.ArcPropOffset, "OpMax");
+	int merged = 0;
+	for (unsigned int k = 0; k < NewArcs.size(); ++k) {
+		vector<Arc>& Members = ArcMembers[k];
+		if ((Members.size() == 1) && (Members[0].Get("From") == NewArcs[k].Get("From")) && (Members[0].Get("To") == NewArcs[k].Get("To")))
+			continue;
+		merged += Members.size() - 1;
+		
+		// Properties are weighted by capacity
+		vector<int> rows(Members.size());
+		for (unsigned int i = 0; i < Members.size(); ++i)
+			rows[i] = FindCode(Members[i], AVectorProp[opmax]);
+		vector<vector<double> > weights = AggWeights(AVectorProp[opmax], rows, ctx.ArcDefault[ctx.ArcPropOffset + opmax], size + 2);
+		vector<double> shares = AggShares(weights, 2);
+		
+		for (unsigned int t = 0; t < AVectorProp.size(); ++t) {
+			string prop = ctx.ArcProp[ctx.ArcPropOffset + t], rule = "weight";
+			if ((prop == "OpMin") || (prop == "OpMax") || (prop == "InvMin") || (prop == "InvMax") || (prop == "Suscep"))
+				rule = "sum";
+			else if ((prop == "InvStep") || (prop == "InvStart") || (prop == "LifeSpan") || (prop == "InvertEff"))
+				rule = "first";
+			for (unsigned int i = 0; i < Members.size(); ++i)
+				rows[i] = FindCode(Members[i], AVectorProp[t]);
+			VectorStr TempRow;
+			if (AggRow(AVectorProp[t], rows, ctx.ArcDefault[ctx.ArcPropOffset + t], 2, weights, rule, TempRow)) {
+				TempRow[0] = NewArcs[k].Get("From");
+				TempRow[1] = NewArcs[k].Get("To");
+				AVectorProp[t].push_back(TempRow);
+			}
+		}
+		
+		for (unsigned int i = 0; (i < Members.size()) && file.is_open(); ++i) {
+			file << NewArcs[k].Get("From") << "_" << NewArcs[k].Get("To") << ",";
+			file << Members[i].Get("From") << "_" << Members[i].Get("To") << "," << shares[i] << endl;
+		}
+	}
+	if (file.is_open()) file.close();
+	
+	cout << "  " << ListNodes.size() << " nodes aggregated into " << NewNodes.size() << ", ";
+	cout << dropped << " arcs within regions dropped and " << merged << " parallel arcs merged" << endl;
+	ListNodes = NewNodes;
+	ListArcs = NewArcs;
+}
+
+void KMedoids(const vector<vector<double> >& dist, const int k, vector<int>& medoid, vector<int>& assign) {
+	int n = dist.size();
+	vector<double> nearest(n, HUGE_VAL);
+	vector<bool> isMedoid(n, false);
+	medoid.clear();
+	
+	// Build: add the medoid that reduces the total distance the most
+	for (int m = 0; m < k; ++m) {
+		int best = -1;
+		double best_cost = HUGE_VAL;
+		for (int c = 0; c < n; ++c) {
+			if (isMedoid[c]) continue;
+			double cost = 0;
+			for (int i = 0; i < n; ++i)
+				cost += min(nearest[i], dist[i][c]);
+			if (cost < best_cost) {
+				best = c;
+				best_cost = cost;
+			}
+		}
+		medoid.push_back(best);
+		isMedoid[best] = true;
+		for (int i = 0; i < n; ++i)
+			nearest[i] = min(nearest[i], dist[i][best]);
+	}
+	
+	// Alternate assignment and medoid update until there are no changes
+	assign.assign(n, 0);
+	bool changed = true;
+	for (int iter = 0; iter <= 100; ++iter) {
+		// Keep the representative periods in chronological order
+		sort(medoid.begin(), medoid.end());
+		for (int i = 0; i < n; ++i) {
+			int best = 0;
+			for (int m = 1; m < k; ++m)
+				if (dist[i][medoid[m]] < dist[i][medoid[best]]) best = m;
+			for (int m = 0; m < k; ++m)
+				if (medoid[m] == i) best = m;
+			assign[i] = best;
+		}
+		if (!changed || (iter == 100)) break;
+		
+		changed = false;
+		for (int m = 0; m < k; ++m) {
+			int best = medoid[m];
+			double best_cost = 0;
+			for (int i = 0; i < n; ++i)
+				if (assign[i] == m) best_cost += dist[i][best];
+			for (int c = 0; c < n; ++c) {
+				if (assign[c] != m) continue;
+				double cost = 0;
+				for (int i = 0; i < n; ++i)
+					if (assign[i] == m) cost += dist[i][c];
+				if (cost < best_cost) {
+					best = c;
+					best_cost = cost;
+				}
+			}
+			if (best != medoid[m]) {
+				medoid[m] = best;
+				changed = true;
+			}
+		}
+	}
+}
@@ -0,0 +1,37 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    aggregate.h -- Definition of temporal aggregation functions
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+#ifndef _AGGREGATE_H_
+#define _AGGREGATE_H_
+
+#include "node.h"
+#include "arc.h"
+
+// Clusters the periods of each group (e.g., the days of each year) into 'RepPeriods'
+// representative periods. The properties in 'data' are rewritten so that they only
+// contain the representative periods, their weights are stored in PeriodWeight and the representative
+// period of each original period in PeriodRep. The assignment is also written in 'fileoutput' (if not NULL)
+void AggregatePeriods(ModelContext& ctx, vector<MatrixStr*>& data, const vector<int>& num_fields, const char* fileoutput);
+
+// Reads the weights and the assignment of the representative periods written by prep. If prep used
+// all the periods (no assignment), RepPeriods is disabled and the original lengths are restored
+void ReadPeriodWeights(ModelContext& ctx, const char* fileinput);
+
+// Values of 'idx' in 'values' for a single period. The representative steps hold the totals of
+// all the periods they stand for, so they are divided by their weight
+vector<string> PeriodValues(const ModelContext& ctx, const Index& idx, const vector<string>& values);
+
+// Collapses the nodes in 'regions' (original code, region code) into aggregated nodes.
+// Demands and capacities are summed, other properties are weighted by demand (nodes) or
+// capacity (arcs), arcs within a region are dropped and parallel arcs are merged. The mapping of
+// nodes and arcs is written in 'fileoutput' (if not NULL)
+void AggregateRegions(const ModelContext& ctx, vector<Node>& ListNodes, vector<Arc>& ListArcs, MatrixStr& NStep, vector<MatrixStr>& NVectorProp,
+	vector<MatrixStr>& AVectorProp, const MatrixStr& regions, const char* fileoutput);
+
+// Clusters the elements with squared distances 'dist' into 'k' groups around medoids
+void KMedoids(const vector<vector<double> >& dist, const int k, vector<int>& medoid, vector<int>& assign);
+
+#endif  // _AGGREGATE_H_
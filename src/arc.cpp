@@ -14,21 +14,24 @@ using namespace std;
 #include "arc.h"
 
 // Contructors and destructor for the Arc class
-Arc::Arc() :
-	Properties(ArcDefault),
+Arc::Arc(const ModelContext& ctx) :
+	Properties(ctx.ArcDefault),
 	Energy2Trans(false),
-	Trans2Energy(0) {}
+	Trans2Energy(0),
+	Context(&ctx) {}
 
 Arc::Arc(const Arc& rhs) :
 	Properties(rhs.GetVecStr("Properties")),
 	Energy2Trans(rhs.GetBool("Energy2Trans")),
-	Trans2Energy(rhs.GetVecStr("Trans2Energy")) {}
+	Trans2Energy(rhs.Trans2Energy),
+	Context(rhs.Context) {}
 
 // This constructor creates an arc going in the opposite direction
 Arc::Arc(const Arc& rhs, const bool reverse) :
 	Properties(rhs.GetVecStr("Properties")),
 	Energy2Trans(rhs.GetBool("Energy2Trans")),
-	Trans2Energy(rhs.GetVecStr("Trans2Energy")) {
+	Trans2Energy(rhs.Trans2Energy),
+	Context(rhs.Context) {
 		if (reverse) {
 			if (!isTransport()) {
 				string temp = Get("To");
@@ -48,14 +51,15 @@ Arc::~Arc() {}
 Arc& Arc::operator=(const Arc& rhs) {
 	Properties = rhs.GetVecStr("Properties");
 	Energy2Trans = rhs.GetBool("Energy2Trans");
-	Trans2Energy = rhs.GetVecStr("Trans2Energy");
+	Trans2Energy = rhs.Trans2Energy;
+	Context = rhs.Context;
 	return *this;
 }
 
 // Read a property in string format
 string Arc::Get(const string& selector) const {
 	string temp_output;
-	int index = FindArcSelector(selector);
+	int index = FindArcSelector(*Context, selector);
 	if (index >= 0) temp_output = Properties[index];
 	else {
 		temp_output = "ERROR";
@@ -66,8 +70,8 @@ string Arc::Get(const string& selector) const {
 
 // Read the year from the step
 string Arc::GetYear() const {
-	int temp = Str2Step(Get("FromStep"))[0];
-	return SName.substr(0,1) + ToString<int>(temp);
+	int temp = Str2Step(*Context, Get("FromStep"))[0];
+	return Context->SName.substr(0,1) + ToString<int>(temp);
 }
 
 // Read a property and convert to double
@@ -91,8 +95,6 @@ vector<string> Arc::GetVecStr(const string& selector) const {
 	vector<string> temp_output;
 	if (selector == "Properties")
 		temp_output = Properties;
-	else if (selector == "Trans2Energy")
-		temp_output = Trans2Energy;
 	else
 		printError("arcread", selector);
 	return temp_output;
@@ -100,7 +102,7 @@ vector<string> Arc::GetVecStr(const string& selector) const {
 
 // Modify a propery
 void Arc::Set(const string& selector, const string& input){
-	int index = FindArcSelector(selector);
+	int index = FindArcSelector(*Context, selector);
 	if (index >= 0)
 		Properties[index] = input;
 	else
@@ -115,21 +117,22 @@ void Arc::Set(const string& selector, const bool input){
 		printError("arcwrite", selector);
 };
 
-// Add a new line to the Trans2Energy vector, where the consumption of energy
+// Add a new load to the Trans2Energy vector, where the consumption of energy
 // for a transportation link is stored
-void Arc::Add(const string& selector, const string& input) {
-	if (selector == "Trans2Energy") Trans2Energy.push_back(input);
-	else printError("arcwrite", selector);
+void Arc::Add(const string& selector, const string& node, const double value) {
+	if (selector == "Trans2Energy") {
+		TransLoad load = {node, value};
+		Trans2Energy.push_back(load);
+	} else printError("arcwrite", selector);
 };
 
 // Multiply a value or a vector by a given value
 void Arc::Multiply(const string& selector, const double value) {
-	int index = FindArcSelector(selector);
+	int index = FindArcSelector(*Context, selector);
 	if (selector == "Trans2Energy") {
 		// Adjust values
-		for (unsigned int i = 1; i < Trans2Energy.size(); i += 2) {
-			Trans2Energy[i] = ToString<double>(value * atof(Trans2Energy[i].c_str()));
-		}
+		for (unsigned int i = 0; i < Trans2Energy.size(); ++i)
+			Trans2Energy[i].Coef *= value;
 	} else if (index >= 0) {
 		double actual = GetDouble(selector);
 		if (actual != 0) {
@@ -194,22 +197,29 @@ string Arc::ArcColumns() const {
 			temp_output += "    " + Get("Code") + " obj " + Get("OpCost") + "\n";
 		}
 		// Sustainability metrics
-		for (int j = 0; j < SustMet.size(); ++j)
-			if (Get("Op" + SustMet[j]) != "0")
-				temp_output += "    " + Get("Code") + " " + SustMet[j] + GetYear() + " " + Get("Op" + SustMet[j]) + "\n";
+		for (int j = 0; j < Context->SustMet.size(); ++j)
+			if (Get("Op" + Context->SustMet[j]) != "0")
+				temp_output += "    " + Get("Code") + " " + Context->SustMet[j] + GetYear() + " " + Get("Op" + Context->SustMet[j]) + "\n";
 	}
 	
 	if (!isTransport()) {
-		// Put arc in the constraint of the origin node
-		if (Get("From")[0] != 'X') {
-			temp_output += "    " + Get("Code") + " " + Get("From") + Get("FromStep") + " -1\n";
-		}
-		// Put arc in the constraint of the destination node
-		if (Get("To")[0] != 'X') {
-			if (InvertEff()) {
-				temp_output += "    " + Get("Code") + " " + Get("To") + Get("ToStep") + " 1\n";
-			} else {
-				temp_output += "    " + Get("Code") + " " + Get("To") + Get("ToStep") + " " + Get("Eff") + "\n";
+		if (Get("From") + Get("FromStep") == Get("To") + Get("ToStep")) {
+			// Storage of a whole representative period is its own cycle, only the losses remain in the node
+			double loss = (InvertEff() ? 1 : GetDouble("Eff")) - 1;
+			if (loss != 0)
+				temp_output += "    " + Get("Code") + " " + Get("From") + Get("FromStep") + " " + ToString<double>(loss) + "\n";
+		} else {
+			// Put arc in the constraint of the origin node
+			if (Get("From")[0] != 'X') {
+				temp_output += "    " + Get("Code") + " " + Get("From") + Get("FromStep") + " -1\n";
+			}
+			// Put arc in the constraint of the destination node
+			if (Get("To")[0] != 'X') {
+				if (InvertEff()) {
+					temp_output += "    " + Get("Code") + " " + Get("To") + Get("ToStep") + " 1\n";
+				} else {
+					temp_output += "    " + Get("Code") + " " + Get("To") + Get("ToStep") + " " + Get("Eff") + "\n";
+				}
 			}
 		}
 		// Upper limit for flows
@@ -261,29 +271,29 @@ string Arc::InvArcColumns() const {
 		
 		// Investment added to the next upper bound contraints
 		Step step1, step2, stepguide, maxstep;
-		step1 = Str2Step(Get("FromStep"));
-		step2 = Str2Step(Get("ToStep"));
+		step1 = Str2Step(*Context, Get("FromStep"));
+		step2 = Str2Step(*Context, Get("ToStep"));
 		if (Get("LifeSpan") != "X") {
-			maxstep = StepSum(step1, Str2Step(Get("LifeSpan")));
-			maxstep = (maxstep > SLength) ? SLength : maxstep;
+			maxstep = StepSum(*Context, step1, Str2Step(*Context, Get("LifeSpan")));
+			maxstep = (maxstep > Context->SLength) ? Context->SLength : maxstep;
 		} else {
-			maxstep = SLength;
+			maxstep = Context->SLength;
 		}
 		
 		stepguide = (step1 > step2) ? step1 : step2;
 		while (stepguide <= maxstep) {
 			temp_output += "    inv" + Get("Code") + " inv2cap";
-			temp_output += Get("From") + Step2Str(step1);
+			temp_output += Get("From") + Step2Str(*Context, step1);
 			if (!isTransport())
-				temp_output += "_" + Get("To") + Step2Str(step2);
+				temp_output += "_" + Get("To") + Step2Str(*Context, step2);
 			
 			temp_output += " -1\n";
 			if (isFirstBidirect() || isFirstTransport()) {
 				Arc Arc2(*this, true);
 				temp_output += "    inv" + Get("Code") + " inv2cap";
-				temp_output += Arc2.Get("From") + Step2Str(step1);
+				temp_output += Arc2.Get("From") + Step2Str(*Context, step1);
 				if (!isTransport()) {
-					temp_output += "_" + Arc2.Get("To") + Step2Str(step2);
+					temp_output += "_" + Arc2.Get("To") + Step2Str(*Context, step2);
 				}
 				temp_output += " -1\n";
 			}
@@ -303,34 +313,54 @@ string Arc::CapArcColumns(int selector) const {
 		if (selector != 1) {
 			// Add capacity as an upper bound for flows withing that year
 			Step step1, step2, stepguide, maxstep;
-			step1 = Str2Step(Get("FromStep"));
-			step2 = Str2Step(Get("ToStep"));
+			step1 = Str2Step(*Context, Get("FromStep"));
+			step2 = Str2Step(*Context, Get("ToStep"));
 			stepguide = (step1 > step2) ? step1 : step2;
 			maxstep = (isStorage()) ? step1 : stepguide;
 			++maxstep[0];
 			
+			// Storage is cyclic within each representative period
+			bool cyclic = isStorage() && (Context->PeriodWeight.size() > 0) && (Context->SName.size() > 2) && (step1[Context->SName.size()-2] != 0);
+			if (cyclic) stepguide = step1;
+			
 			string common = "    cap" + Get("Code") + " ub";
 			while (stepguide < maxstep) {
+				if (cyclic) step2 = CyclicStep(*Context, step1);
 				temp_output += common;
-				temp_output += Get("From") + Step2Str(step1);
+				temp_output += Get("From") + Step2Str(*Context, step1);
 				if (!isTransport())
-					temp_output += "_" + Get("To") + Step2Str(step2);
+					temp_output += "_" + Get("To") + Step2Str(*Context, step2);
 				
 				if (InvertEff()) {
-					string reduced_cap = ToString<double>(GetDouble("Eff") * atof(Step2Hours(stepguide).c_str()));
+					string reduced_cap = ToString<double>(GetDouble("Eff") * atof(Step2Hours(*Context, stepguide).c_str()));
 					temp_output += " -" + reduced_cap + "\n";
 				} else if (Get("InvertEff") == "1") {
 					temp_output += " -1\n";
 				} else {
-					temp_output += " -" + Step2Hours(stepguide) + "\n";
+					temp_output += " -" + Step2Hours(*Context, stepguide) + "\n";
 				}
 				
 				// Move to the next year
-				stepguide = NextStep(stepguide);
-				if (NextStep(step1) <= stepguide)
-					step1 = NextStep(step1);
-				if (NextStep(step2) <= stepguide)
-					step2 = NextStep(step2);
+				stepguide = NextStep(*Context, stepguide);
+				if (NextStep(*Context, step1) <= stepguide)
+					step1 = NextStep(*Context, step1);
+				if (!cyclic && (NextStep(*Context, step2) <= stepguide))
+					step2 = NextStep(*Context, step2);
+			}
+			
+			// The states of the original periods have the same limit, for a single period (no weight)
+			if (isLinked()) {
+				Step first = Str2Step(*Context, Get("FromStep"));
+				double hours = atof(Step2Hours(*Context, first).c_str()) / StepWeight(*Context, first);
+				string limit = ToString<double>(hours);
+				if (InvertEff())
+					limit = ToString<double>(GetDouble("Eff") * hours);
+				else if (Get("InvertEff") == "1")
+					limit = "1";
+				
+				vector<Step> periods = YearPeriods(*Context, Time(), Context->SFullLength);
+				for (unsigned int d = 0; d < periods.size(); ++d)
+					temp_output += "    cap" + Get("Code") + " ubsoc" + Get("From") + Step2Str(*Context, periods[d]) + " -" + limit + "\n";
 			}
 		}
 		if (selector != 2) {
@@ -354,7 +384,7 @@ vector<string> Arc::Events() const {
 	if (isFirstinYear() && (Get("OpMax") != "Inf") && (Get("TransInfr") == "")) {
 		// Base case
 		temp_output.push_back("1");
-		for (int event = 1; event <= Nevents; ++event) {
+		for (int event = 1; event <= Context->Nevents; ++event) {
 			// For events
 			string property = "CapacityLoss" + ToString<int>(event);
 			temp_output.push_back(Get(property));
@@ -393,6 +423,69 @@ string Arc::ArcInvBounds() const {
 	return temp_output;
 }
 
+string Arc::LinkNames() const {
+	string temp_output = "";
+	// State of the storage at the start of each original period and its limit
+	if (isLinked()) {
+		vector<Step> periods = YearPeriods(*Context, Time(), Context->SFullLength);
+		for (unsigned int d = 0; d < periods.size(); ++d) {
+			temp_output += " E lnk" + Get("From") + Step2Str(*Context, periods[d]) + "\n";
+			if (Get("OpMax") != "Inf")
+				temp_output += " L ubsoc" + Get("From") + Step2Str(*Context, periods[d]) + "\n";
+		}
+	}
+	return temp_output;
+}
+
+string Arc::LinkColumns() const {
+	string temp_output = "";
+	if (isLinked()) {
+		int p = Context->SName.size() - 2;
+		Step step1 = Str2Step(*Context, Get("FromStep"));
+		vector<Step> periods = YearPeriods(*Context, Time(), Context->SFullLength);
+		vector<Step> reps = YearPeriods(*Context, Time(), Context->SLength);
+		vector<Step> assigned(periods.size());
+		for (unsigned int d = 0; d < periods.size(); ++d)
+			assigned[d] = RepPeriod(*Context, periods[d]);
+		
+		// Net change of each representative period (for all the periods it stands for). It leaves
+		// the node at the last step of the period and changes the state of the periods assigned to it
+		for (unsigned int r = 0; r < reps.size(); ++r) {
+			string net = "    net" + Get("From") + Step2Str(*Context, reps[r]);
+			Step last = reps[r];
+			for (unsigned int k = p+1; k < last.size(); ++k)
+				if (step1[k] != 0) last[k] = Context->SLength[k];
+			temp_output += net + " " + Get("From") + Step2Str(*Context, last) + " -1\n";
+			for (unsigned int d = 0; d < periods.size(); ++d)
+				if (assigned[d] == reps[r])
+					temp_output += net + " lnk" + Get("From") + Step2Str(*Context, periods[d]) + " -1\n";
+		}
+		
+		// States of the original periods: weight * (next state - state) = net change of the representative
+		// period. The state after the last period of the year is the one of the first period
+		for (unsigned int d = 0; d < periods.size(); ++d) {
+			string soc = "    soc" + Get("From") + Step2Str(*Context, periods[d]);
+			unsigned int prev = (d + periods.size() - 1) % periods.size();
+			temp_output += soc + " lnk" + Get("From") + Step2Str(*Context, periods[d]) + " -" + ToString<double>(StepWeight(*Context, assigned[d])) + "\n";
+			temp_output += soc + " lnk" + Get("From") + Step2Str(*Context, periods[prev]) + " " + ToString<double>(StepWeight(*Context, assigned[prev])) + "\n";
+			if (Get("OpMax") != "Inf")
+				temp_output += soc + " ubsoc" + Get("From") + Step2Str(*Context, periods[d]) + " 1\n";
+		}
+	}
+	return temp_output;
+}
+
+string Arc::LinkBounds() const {
+	string temp_output = "";
+	// The net change of a representative period can have any sign
+	if (isLinked()) {
+		vector<Step> reps = YearPeriods(*Context, Time(), Context->SLength);
+		for (unsigned int r = 0; r < reps.size(); ++r)
+			temp_output += " FR bnd net" + Get("From") + Step2Str(*Context, reps[r]) + "\n";
+	}
+	return temp_output;
+}
+
 string Arc::WriteEnergy2Trans() const {
 	string temp_output = "";
 	// Load on the transportation side created by a coal/energy arc
@@ -404,16 +497,20 @@ string Arc::WriteEnergy2Trans() const {
 
 string Arc::WriteTrans2Energy() const {
 	string temp_output = "";
-	// Energy demand for a transportation node that requires it
-	for (int k=0; k+1 < Trans2Energy.size(); k+=2)
-		temp_output += "    " + Get("Code") + " " + Trans2Energy[k] + " -" + Trans2Energy[k+1] + "\n";
+	// Energy demand for a transportation node that requires it (same precision as the input data)
+	for (unsigned int k=0; k < Trans2Energy.size(); ++k) {
+		stringstream value;
+		value.precision(15);
+		value << -Trans2Energy[k].Coef;
+		temp_output += "    " + Get("Code") + " " + Trans2Energy[k].Node + " " + value.str() + "\n";
+	}
 	
 	return temp_output;
 }
 
 // Get what time the arc belongs to (i.e., year)
 int Arc::Time() const {
-	return Str2Step(Get("FromStep"))[0];
+	return Str2Step(*Context, Get("FromStep"))[0];
 }
 
 
@@ -423,15 +520,28 @@ int Arc::Time() const {
 bool Arc::isFirstinYear() const {
 	bool output = true;
 	Step step1, step2, stepguide;
-	step1 = Str2Step(Get("FromStep"));
-	step2 = Str2Step(Get("ToStep"));
+	step1 = Str2Step(*Context, Get("FromStep"));
+	step2 = Str2Step(*Context, Get("ToStep"));
 	stepguide = ((step1 > step2) || isStorage()) ? step1 : step2;
-	for (unsigned int k = Get("InvStep").size(); k < SName.size(); k++) {
+	for (unsigned int k = Get("InvStep").size(); k < Context->SName.size(); k++) {
 		output = output && ((stepguide[k]==0) || (stepguide[k]==1));
 	}
 	return output;
 }
 
+// Is it the first arc in a year of storage within representative periods? The state of the
+// storage is then linked between the original periods of the year
+bool Arc::isLinked() const {
+	int p = Context->SName.size() - 2;
+	if (!isStorage() || (Context->PeriodWeight.size() == 0) || (p < 1))
+		return false;
+	Step step1 = Str2Step(*Context, Get("FromStep"));
+	bool output = (step1[p] != 0);
+	for (unsigned int k = 1; k < step1.size(); k++)
+		output = output && (step1[k] <= 1);
+	return output;
+}
+
 // Is investment allowed for current arc?
 bool Arc::InvArc() const {
 	// Inv. cost is declared and it's the first arc in each investment period
@@ -439,7 +549,7 @@ bool Arc::InvArc() const {
 	// It's the first if the arc is bidirectional
 	output = output && (!isTransport() && (!isBidirect() || isFirstBidirect()) || isFirstTransport() );
 	// Technology is available
-	output = output && (Str2Step(Get("FromStep")) >= Str2Step(Get("InvStart")));
+	output = output && (Str2Step(*Context, Get("FromStep")) >= Str2Step(*Context, Get("InvStart")));
 	return output;
 }
 
@@ -450,13 +560,13 @@ bool Arc::InvertEff() const {
 
 // Is the arc part of DC flow constraints?
 bool Arc::isDCflow() const {
-	bool output = (Get("From").substr(0,2) == DCCode) && (Get("To").substr(0,2) == DCCode);
-	return output && useDCflow;
+	bool output = (Get("From").substr(0,2) == Context->DCCode) && (Get("To").substr(0,2) == Context->DCCode);
+	return output && Context->useDCflow;
 }
 
 // Is it a storage arc?
 bool Arc::isStorage() const {
-	return (Get("From").substr(1,1) == StorageCode) && (Get("From") == Get("To"));
+	return (Get("From").substr(1,1) == Context->StorageCode) && (Get("From") == Get("To"));
 }
 
 // Is the arc bidirectional? (excludes storage nodes)
@@ -484,10 +594,10 @@ bool Arc::isFirstTransport() const {
 
 // ****** Other functions ******
 // Find the index for a arc property selector
-int FindArcSelector(const string& selector) {
+int FindArcSelector(const ModelContext& ctx, const string& selector) {
 	int index = -1;
-	for (unsigned int k = 0; k < ArcProp.size(); ++k) {
-		if (selector == ArcProp[k]) index = k;
+	for (unsigned int k = 0; k < ctx.ArcProp.size(); ++k) {
+		if (selector == ctx.ArcProp[k]) index = k;
 	}
 	return index;
 }
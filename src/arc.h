@@ -7,10 +7,16 @@
 #ifndef _ARC_H_
 #define _ARC_H_
 
+// Energy consumed at a node (code and step) per unit of flow of a transportation arc
+struct TransLoad {
+	string Node;
+	double Coef;
+};
+
 // Declare class to store arc information
 class Arc {
 	public:
-		Arc();
+		Arc(const ModelContext& ctx);
 		Arc(const Arc& rhs);
 		Arc(const Arc& rhs, const bool reverse);
 		~Arc();
@@ -23,7 +29,7 @@ class Arc {
 		vector<string> GetVecStr(const string& selector) const;
 		void Set(const string& selector, const string& input);
 		void Set(const string& selector, const bool input);
-		void Add(const string& selector, const string& input);
+		void Add(const string& selector, const string& node, const double value);
 		void Multiply(const string& selector, const double value);
 		int Time() const;
 		
@@ -40,8 +46,12 @@ class Arc {
 		string ArcRhs() const;
 		string ArcBounds() const;
 		string ArcInvBounds() const;
+		string LinkNames() const;
+		string LinkColumns() const;
+		string LinkBounds() const;
 		
 		bool isFirstinYear() const;
+		bool isLinked() const;
 		bool InvArc() const;
 		bool InvertEff() const;
 		bool isDCflow() const;
@@ -52,11 +62,13 @@ class Arc {
 		bool isFirstTransport() const;
 	
 	private:
-		vector<string> Properties, Trans2Energy;
+		vector<string> Properties;
+		vector<TransLoad> Trans2Energy;
 		bool Energy2Trans;
+		const ModelContext* Context;
 };
 
 // Find the index for a arc property selector
-int FindArcSelector(const string& selector);
+int FindArcSelector(const ModelContext& ctx, const string& selector);
 
 #endif  // _NODE_H_
@@ -0,0 +1,157 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    evalcache.cpp -- Implementation of the cache of evaluated individuals
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+using namespace std;
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <cstdio>
+#include "global.h"
+#include "evalcache.h"
+
+// Contructor for the EvalCache class
+EvalCache::EvalCache() :
+	hits(0), misses(0), file(""), nvars(0), nobj(0) {}
+
+// Reads the entries stored in 'fileinput' (if it was written for the same number of variables
+// and objectives) and keeps the file to append new entries. Each line has the variables, the
+// objectives, a flag if the metrics are stored and the metrics (which start with a comma)
+void EvalCache::Open(const char* fileinput, const int numvars, const int numobj) {
+	file = fileinput;
+	nvars = numvars;
+	nobj = numobj;
+	entries.clear(); table.clear(); pending.clear();
+	
+	string header = "% Evaluation cache," + ToString<int>(nvars) + "," + ToString<int>(nobj);
+	ifstream infile(fileinput);
+	string line;
+	if (infile.is_open() && getline(infile, line) && (line == header)) {
+		while (getline(infile, line)) {
+			// Split variables, objectives and flag, the rest of the line are the metrics
+			vector<string> fields;
+			size_t begin = 0, end;
+			while ((fields.size() < nvars + nobj + 1) && ((end = line.find(',', begin)) != string::npos)) {
+				fields.push_back(line.substr(begin, end - begin));
+				begin = end + 1;
+			}
+			if (fields.size() < nvars + nobj) continue;
+			if (fields.size() == nvars + nobj) {
+				fields.push_back(line.substr(begin));
+				begin = line.size();
+			}
+			
+			vector<double> x(nvars), objective(nobj);
+			for (int k = 0; k < nvars; ++k)
+				x[k] = atof(fields[k].c_str());
+			for (int k = 0; k < nobj; ++k)
+				objective[k] = atof(fields[nvars + k].c_str());
+			string metrics = (begin < line.size()) ? line.substr(begin - 1) : "";
+			Add(&x[0], &objective[0], (fields[nvars + nobj] == "1") ? &metrics : NULL);
+		}
+		pending.clear();
+		infile.close();
+		cout << "- Evaluation cache: " << entries.size() << " individuals read from " << fileinput << endl;
+	} else {
+		// New cache (or written for a different problem)
+		infile.close();
+		ofstream outfile(fileinput);
+		outfile << header << endl;
+		outfile.close();
+	}
+}
+
+bool EvalCache::IsOpen() const {
+	return (file != "");
+}
+
+// Copies the objectives (and the metrics if requested) of an individual that was already evaluated
+bool EvalCache::Find(const double *x, double *objective, string *returnString) {
+	int k = Position(Key(x));
+	if ((k < 0) || ((returnString != NULL) && !entries[k].hasString)) {
+		++misses;
+		return false;
+	}
+	
+	for (int j = 0; j < nobj; ++j)
+		objective[j] = entries[k].obj[j];
+	if (returnString != NULL)
+		*returnString = entries[k].metrics;
+	++hits;
+	return true;
+}
+
+// Adds (or updates) an individual, which is written to the file with the next flush
+void EvalCache::Add(const double *x, const double *objective, const string *returnString) {
+	string key = Key(x);
+	int k = Position(key);
+	if (k < 0) {
+		k = entries.size();
+		entries.push_back(Entry());
+		entries[k].key = key;
+		entries[k].hasString = false;
+		table[Hash(key)].push_back(k);
+	}
+	
+	entries[k].obj.assign(objective, objective + nobj);
+	if (returnString != NULL) {
+		entries[k].hasString = true;
+		entries[k].metrics = *returnString;
+	}
+	pending.push_back(k);
+}
+
+// Appends the new entries to the file
+void EvalCache::Flush() {
+	if (!IsOpen() || pending.empty())
+		return;
+	
+	ofstream outfile(file.c_str(), ios::app);
+	outfile.precision(17);
+	for (unsigned int i = 0; i < pending.size(); ++i) {
+		const Entry& entry = entries[pending[i]];
+		outfile << entry.key;
+		for (int j = 0; j < nobj; ++j)
+			outfile << "," << entry.obj[j];
+		outfile << "," << (entry.hasString ? "1" : "0") << entry.metrics << endl;
+	}
+	outfile.close();
+	pending.clear();
+}
+
+// Variables rounded to 12 digits, so that small differences in the decoding do not matter
+string EvalCache::Key(const double *x) const {
+	string key = "";
+	char value[32];
+	for (int k = 0; k < nvars; ++k) {
+		sprintf(value, "%.12g", x[k]);
+		key += ((k > 0) ? "," : "") + string(value);
+	}
+	return key;
+}
+
+// FNV-1a hash of the key
+unsigned long long EvalCache::Hash(const string& key) const {
+	unsigned long long hash = 14695981039346656037ULL;
+	for (unsigned int k = 0; k < key.size(); ++k) {
+		hash ^= (unsigned char) key[k];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+// Position of the entry with the given key (-1 if it is not in the cache)
+int EvalCache::Position(const string& key) const {
+	map<unsigned long long, vector<int> >::const_iterator it = table.find(Hash(key));
+	if (it == table.end())
+		return -1;
+	for (unsigned int i = 0; i < it->second.size(); ++i)
+		if (entries[it->second[i]].key == key)
+			return it->second[i];
+	return -1;
+}
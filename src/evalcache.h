@@ -0,0 +1,49 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    evalcache.h -- Definition of the cache of evaluated individuals
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+#ifndef _EVALCACHE_H_
+#define _EVALCACHE_H_
+
+#include <map>
+
+// Declare class type to keep the objectives of the individuals already evaluated, keyed by a hash
+// of their decoded variables (xbin, rounded to 12 digits). The string of metrics returned by the
+// solver (the one written by postnsga) is also kept when it is available. New entries are appended
+// to a file, so the cache is shared by later runs (resumed populations, postnsga) until the
+// preprocessor is run again.
+class EvalCache {
+	public:
+		EvalCache();
+		
+		void Open(const char* fileinput, const int numvars, const int numobj);
+		bool IsOpen() const;
+		bool Find(const double *x, double *objective, string *returnString = NULL);
+		void Add(const double *x, const double *objective, const string *returnString = NULL);
+		void Flush();
+		
+		// Lookups since the counters were reset
+		long hits, misses;
+	
+	private:
+		struct Entry {
+			string key;
+			vector<double> obj;
+			bool hasString;
+			string metrics;
+		};
+		
+		string Key(const double *x) const;
+		unsigned long long Hash(const string& key) const;
+		int Position(const string& key) const;
+		
+		string file;
+		int nvars, nobj;
+		vector<Entry> entries;
+		map<unsigned long long, vector<int> > table;
+		vector<int> pending;
+};
+
+#endif  // _EVALCACHE_H_
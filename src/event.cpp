@@ -0,0 +1,113 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    event.cpp -- Implementation of resiliency event functions
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+using namespace std;
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "global.h"
+#include "event.h"
+
+// Contructor for the EventStore class
+EventStore::EventStore() :
+	start(1, 0), cap(0), year(0), factor(0), ystart(1, 0), years(0),
+	AddEvent(0), AddCap(0), AddYear(0), AddFactor(0) {}
+
+// Add a capacity loss, which is stored until the events are compressed
+void EventStore::Add(const int newevent, const int newcap, const int newyear, const double newfactor) {
+	AddEvent.push_back(newevent);
+	AddCap.push_back(newcap);
+	AddYear.push_back(newyear);
+	AddFactor.push_back(newfactor);
+}
+
+// Sort the entries by event and find the years affected by each one
+void EventStore::Compress(const int numevents) {
+	start.assign(numevents + 2, 0);
+	for (unsigned int i = 0; i < AddEvent.size(); ++i)
+		++start[AddEvent[i] + 1];
+	for (int e = 0; e <= numevents; ++e)
+		start[e+1] += start[e];
+	
+	cap.resize(AddEvent.size());
+	year.resize(AddEvent.size());
+	factor.resize(AddEvent.size());
+	vector<int> position(start.begin(), start.end() - 1);
+	for (unsigned int i = 0; i < AddEvent.size(); ++i) {
+		int k = position[AddEvent[i]]++;
+		cap[k] = AddCap[i];
+		year[k] = AddYear[i];
+		factor[k] = AddFactor[i];
+	}
+	AddEvent.clear(); AddCap.clear(); AddYear.clear(); AddFactor.clear();
+	
+	// Affected years, the base case includes all of them
+	vector<vector<int> > TempYears(numevents + 1);
+	for (int e = 1; e <= numevents; ++e) {
+		for (int k = start[e]; k < start[e+1]; ++k) {
+			TempYears[e].push_back(year[k]);
+			TempYears[0].push_back(year[k]);
+		}
+	}
+	ystart.assign(1, 0);
+	years.clear();
+	for (int e = 0; e <= numevents; ++e) {
+		sort(TempYears[e].begin(), TempYears[e].end());
+		TempYears[e].erase(unique(TempYears[e].begin(), TempYears[e].end()), TempYears[e].end());
+		years.insert(years.end(), TempYears[e].begin(), TempYears[e].end());
+		ystart.push_back(years.size());
+	}
+}
+
+// Does the event change any capacity in the year?
+bool EventStore::Affects(const int event, const int year) const {
+	if (event + 1 >= ystart.size()) return false;
+	for (int k = ystart[event]; k < ystart[event+1]; ++k)
+		if (years[k] == year) return true;
+	return false;
+}
+
+// Write a file
+void EventStore::WriteFile(const char* fileinput) const {
+	ofstream myfile;
+	myfile.open(fileinput);
+	myfile << "% Event, capacity index, year, fraction of capacity available" << endl;
+	for (int e = 1; e + 1 < start.size(); ++e)
+		for (int k = start[e]; k < start[e+1]; ++k)
+			myfile << e << "," << cap[k] << "," << year[k] << "," << factor[k] << "\n";
+	myfile.close();
+}
+
+// Read a file
+EventStore ReadEventStore(const ModelContext& ctx, const char* fileinput) {
+	EventStore TempEvents;
+	char line[200];
+	FILE *file = fopen(fileinput, "r");
+	
+	if (file != NULL) {
+		for (;;) {
+			// Read a line from the file and finish if empty is read
+			if (fgets(line, sizeof line, file) == NULL) break;
+			CleanLine(line);
+			if ((line[0] == '%') || (line[0] == '\0')) continue;
+			
+			int event = atoi(strtok(line, ","));
+			int cap = atoi(strtok(NULL, ","));
+			int year = atoi(strtok(NULL, ","));
+			double factor = atof(strtok(NULL, ","));
+			TempEvents.Add(event, cap, year, factor);
+		}
+		fclose(file);
+	} else {
+		printError("error", fileinput);
+	}
+	TempEvents.Compress(ctx.Nevents);
+	return TempEvents;
+}
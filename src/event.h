@@ -0,0 +1,36 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    event.h -- Definition of resiliency event functions
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+#ifndef _EVENT_H_
+#define _EVENT_H_
+
+// Declare class type to hold the capacity losses of the resiliency events in sparse form.
+// Only the capacities that change are stored: entries of event e go from start[e] to start[e+1]-1
+// and the years it affects from ystart[e] to ystart[e+1]-1. Event 0 (base case) has no entries
+// and affects all the years affected by any event.
+class EventStore {
+	public:
+		EventStore();
+		
+		void Add(const int newevent, const int newcap, const int newyear, const double newfactor);
+		void Compress(const int numevents);
+		bool Affects(const int event, const int year) const;
+		void WriteFile(const char* fileinput) const;
+		
+		// Variables
+		vector<int> start, cap, year;
+		vector<double> factor;
+		vector<int> ystart, years;
+	
+	private:
+		// Entries before compression
+		vector<int> AddEvent, AddCap, AddYear;
+		vector<double> AddFactor;
+};
+
+EventStore ReadEventStore(const ModelContext& ctx, const char* fileinput);
+
+#endif  // _EVENT_H_
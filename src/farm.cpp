@@ -0,0 +1,318 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    farm.cpp -- Implementation of the local farm of evaluation processes
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+using namespace std;
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <cerrno>
+#include <cstdlib>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include "farm.h"
+
+// Number of workers that an individual may kill before it is considered infeasible
+#define FARM_TRIES 3
+
+// Reads or writes a whole message (false if the other end is closed)
+static bool ReadAll(const int fd, void *data, const size_t size) {
+	char *p = (char *) data;
+	size_t left = size;
+	while (left > 0) {
+		ssize_t n = read(fd, p, left);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		p += n; left -= n;
+	}
+	return true;
+}
+
+static bool WriteAll(const int fd, const void *data, const size_t size) {
+	const char *p = (const char *) data;
+	size_t left = size;
+	while (left > 0) {
+		ssize_t n = write(fd, p, left);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		p += n; left -= n;
+	}
+	return true;
+}
+
+// Seconds since the epoch
+static double WallTime() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+EvalFarm::EvalFarm(ModelContext& context, const EventStore& ev): ctx(context), events(ev),
+	nvars(context.IdxNsga.size), nobj(context.Nobj), done(0), restarts(0), started(0), busy(0) {}
+
+EvalFarm::~EvalFarm() {
+	Stop();
+}
+
+void EvalFarm::Start(int nworkers) {
+	if (nworkers <= 0)
+		nworkers = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nworkers <= 0)
+		nworkers = 1;
+
+	// A worker that dies must not stop the coordinator when it writes to its socket
+	signal(SIGPIPE, SIG_IGN);
+
+	cout << "- Starting " << nworkers << " evaluation processes" << endl;
+	workers.resize(nworkers);
+	for (int w=0; w < nworkers; ++w) {
+		// The workers forked first must not close anything for the ones that do not exist yet
+		workers[w].pid = -1;
+		workers[w].fd = -1;
+		workers[w].job = -1;
+		workers[w].done = 0;
+	}
+	for (int w=0; w < nworkers; ++w)
+		Spawn(w);
+	started = WallTime();
+}
+
+void EvalFarm::Stop() {
+	if (workers.empty())
+		return;
+
+	// Closing the sockets ends the workers
+	for (unsigned int w=0; w < workers.size(); ++w) {
+		if (workers[w].fd >= 0) close(workers[w].fd);
+		if (workers[w].pid > 0) waitpid(workers[w].pid, NULL, 0);
+	}
+	Report();
+	workers.clear();
+}
+
+// Forks worker w, which loads the problem, reports that it is ready (job -1) and serves evaluations
+// until its socket is closed
+bool EvalFarm::Spawn(const int w) {
+	int fds[2];
+	workers[w].pid = -1;
+	workers[w].fd = -1;
+	workers[w].job = -1;
+	workers[w].ready = false;
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+		cout << "\tERROR: Socket for evaluation process could not be created" << endl;
+		return false;
+	}
+
+	// Anything still in the buffers would be written twice
+	cout.flush(); cerr.flush();
+	pid_t pid = fork();
+	if (pid < 0) {
+		cout << "\tERROR: Evaluation process could not be started" << endl;
+		close(fds[0]); close(fds[1]);
+		return false;
+	}
+
+	if (pid == 0) {
+		// Worker: only its own end of the socket stays open
+		close(fds[0]);
+		for (unsigned int k=0; k < workers.size(); ++k)
+			if ((k != w) && (workers[k].fd >= 0)) close(workers[k].fd);
+
+		CPLEX netplan(ctx);
+		netplan.LoadProblem();
+		int ready = -1;
+		if (WriteAll(fds[1], &ready, sizeof(int)))
+			Serve(netplan, events, fds[1], fds[1]);
+		close(fds[1]);
+		_exit(0);
+	}
+
+	close(fds[1]);
+	workers[w].pid = pid;
+	workers[w].fd = fds[0];
+	return true;
+}
+
+int EvalFarm::Submit(const vector<double*>& x, const vector<double*>& objective, const vector<string*>& metrics) {
+	int batch = pending.size();
+	pending.push_back(x.size());
+	first.push_back(jobs.size());
+	for (unsigned int i=0; i < x.size(); ++i) {
+		Job job = {x[i], objective[i], (i < metrics.size()) ? metrics[i] : NULL, batch, 0, false};
+		queue.push_back(jobs.size());
+		jobs.push_back(job);
+	}
+	if (x.empty())
+		completed.push_back(batch);
+	Dispatch();
+	return batch;
+}
+
+void EvalFarm::Wait(const int batch) {
+	while (pending[batch] > 0) {
+		Dispatch();
+		Collect();
+	}
+	for (deque<int>::iterator it = completed.begin(); it != completed.end(); ++it) {
+		if (*it == batch) {
+			completed.erase(it);
+			break;
+		}
+	}
+}
+
+int EvalFarm::WaitAny() {
+	while (completed.empty()) {
+		Dispatch();
+		Collect();
+	}
+	int batch = completed.front();
+	completed.pop_front();
+	return batch;
+}
+
+int EvalFarm::Size() const {
+	return workers.size();
+}
+
+bool EvalFarm::Returned(const int batch, const int i) const {
+	return jobs[first[batch] + i].returned;
+}
+
+// Sends queued individuals to the idle workers
+void EvalFarm::Dispatch() {
+	for (unsigned int w=0; (w < workers.size()) && !queue.empty(); ++w) {
+		if ((workers[w].fd < 0) || !workers[w].ready || (workers[w].job >= 0))
+			continue;
+		int job = queue.front();
+		queue.pop_front();
+		workers[w].job = job;
+		workers[w].sent = WallTime();
+		if (!WriteAll(workers[w].fd, &job, sizeof(int)) ||
+			!WriteAll(workers[w].fd, jobs[job].x, nvars * sizeof(double)))
+			Fail(w);
+	}
+}
+
+// Waits for the results of the busy workers and for the workers that are loading the problem
+void EvalFarm::Collect() {
+	vector<struct pollfd> fds;
+	vector<int> active;
+	for (unsigned int w=0; w < workers.size(); ++w) {
+		if ((workers[w].fd >= 0) && (!workers[w].ready || (workers[w].job >= 0))) {
+			struct pollfd p = {workers[w].fd, POLLIN, 0};
+			fds.push_back(p);
+			active.push_back(w);
+		}
+	}
+	if (fds.empty()) {
+		// The idle workers always get an individual first, so none is left
+		cout << "\tERROR: No evaluation process could be started or load the problem" << endl;
+		exit(1);
+	}
+
+	if (poll(&fds[0], fds.size(), -1) < 0)
+		return;
+
+	for (unsigned int k=0; k < fds.size(); ++k) {
+		if (fds[k].revents == 0)
+			continue;
+		int w = active[k], job;
+		if (!workers[w].ready) {
+			if (!ReadAll(workers[w].fd, &job, sizeof(int)) || (job != -1))
+				Fail(w);
+			else
+				workers[w].ready = true;
+			continue;
+		}
+		int length;
+		if (!ReadAll(workers[w].fd, &job, sizeof(int)) || (job != workers[w].job) ||
+			!ReadAll(workers[w].fd, jobs[job].obj, nobj * sizeof(double)) ||
+			!ReadAll(workers[w].fd, &length, sizeof(int)) || (length < 0)) {
+			Fail(w);
+			continue;
+		}
+		string text(length, ' ');
+		if ((length > 0) && !ReadAll(workers[w].fd, &text[0], length)) {
+			Fail(w);
+			continue;
+		}
+		if (jobs[job].metrics != NULL)
+			*jobs[job].metrics = text;
+		workers[w].job = -1;
+		jobs[job].returned = true;
+		++workers[w].done;
+		busy += WallTime() - workers[w].sent;
+		Finish(job);
+	}
+}
+
+void EvalFarm::Finish(const int job) {
+	int batch = jobs[job].batch;
+	if (--pending[batch] == 0)
+		completed.push_back(batch);
+	++done;
+}
+
+// Replaces a worker that died (or broke the protocol) and sends its individual again. A worker that
+// could not load the problem is not replaced, the next one would fail in the same way
+void EvalFarm::Fail(const int w) {
+	int job = workers[w].job;
+	close(workers[w].fd);
+	waitpid(workers[w].pid, NULL, 0);
+	if (!workers[w].ready) {
+		cout << "\tWarning: Evaluation process " << workers[w].pid << " stopped while loading the problem" << endl;
+		workers[w].pid = -1;
+		workers[w].fd = -1;
+		return;
+	}
+	++restarts;
+
+	if (job >= 0) {
+		if (++jobs[job].tries < FARM_TRIES) {
+			queue.push_front(job);
+		} else {
+			cout << "\tWarning: Individual lost " << FARM_TRIES << " workers, it is considered infeasible" << endl;
+			for (int k=0; k < nobj; ++k)
+				jobs[job].obj[k] = 1.0e30;
+			Finish(job);
+		}
+	}
+
+	cout << "\tWarning: Evaluation process " << workers[w].pid << " stopped, starting a new one" << endl;
+	Spawn(w);
+}
+
+void EvalFarm::Report() {
+	double elapsed = WallTime() - started;
+	cout << "\tEvaluation farm: " << done << " individuals in " << elapsed << " s";
+	if (elapsed > 0)
+		cout << " (" << done * 3600.0 / elapsed << " per hour, " << 100.0 * busy / (elapsed * workers.size()) << "% use)";
+	cout << ", " << restarts << " restarts" << endl;
+	cout << "\t\tPer process:";
+	for (unsigned int w=0; w < workers.size(); ++w)
+		cout << " " << workers[w].done;
+	cout << endl;
+}
+
+void EvalFarm::Serve(CPLEX& netplan, const EventStore& events, const int in, const int out) {
+	int nvars = netplan.ctx.IdxNsga.size, nobj = netplan.ctx.Nobj, job;
+	vector<double> x(nvars), objective(nobj);
+	while (ReadAll(in, &job, sizeof(int)) && (job >= 0)) {
+		if (!ReadAll(in, &x[0], nvars * sizeof(double)))
+			break;
+		string metrics = "";
+		netplan.SolveProblem(&x[0], &objective[0], events, &metrics);
+		int length = metrics.size();
+		if (!WriteAll(out, &job, sizeof(int)) || !WriteAll(out, &objective[0], nobj * sizeof(double)) ||
+			!WriteAll(out, &length, sizeof(int)) || !WriteAll(out, metrics.data(), length))
+			break;
+	}
+}
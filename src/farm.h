@@ -0,0 +1,89 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    farm.h -- Definition of the local farm of evaluation processes
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+#ifndef _FARM_H_
+#define _FARM_H_
+
+using namespace std;
+#include <vector>
+#include <deque>
+#include <sys/types.h>
+#include "global.h"
+#include "event.h"
+#include "solver.h"
+
+// Declare class type to evaluate individuals in several local processes. The workers are forked
+// after the case is read, so the parameters, indices and events are shared (copy-on-write), and
+// each one loads the optimization problem once. The decoded variables of an individual are sent
+// over a Unix socket to the first free worker, which returns its objectives. A worker that dies is
+// replaced and its individual is sent again (an individual that kills several workers is infeasible).
+// A worker only gets individuals once it reports that the problem is loaded; one that dies before
+// is not replaced, and the coordinator stops if no worker is left.
+class EvalFarm {
+	public:
+		EvalFarm(ModelContext& context, const EventStore& events);
+		~EvalFarm();
+
+		// Starts the workers (0 uses one per processor) and stops them
+		void Start(int workers);
+		void Stop();
+
+		// Queues a group of individuals (their variables are read when they are sent, the objectives
+		// and the string of metrics, if given, are written when they return) and waits until all the
+		// individuals of a group are evaluated
+		int Submit(const vector<double*>& x, const vector<double*>& objective, const vector<string*>& metrics = vector<string*>());
+		void Wait(const int batch);
+
+		// Waits until any group is evaluated and returns it (asynchronous use), and number of workers
+		int WaitAny();
+		int Size() const;
+
+		// Whether individual i of a group was evaluated by a worker (false if it was lost)
+		bool Returned(const int batch, const int i) const;
+
+		// Evaluations, time, use of the workers and restarts since the start
+		void Report();
+
+		ModelContext& ctx;
+
+		// Evaluates the individuals received in 'in' and sends the objectives and the metrics (length
+		// and characters) to 'out' until the coordinator closes the connection (used by the workers
+		// and by nsga2-individual)
+		static void Serve(CPLEX& netplan, const EventStore& events, const int in, const int out);
+
+	private:
+		struct Job {
+			double *x, *obj;
+			string *metrics;
+			int batch, tries;
+			bool returned;
+		};
+		struct Worker {
+			pid_t pid;
+			int fd, job;
+			bool ready;
+			long done;
+			double sent;
+		};
+
+		bool Spawn(const int w);
+		void Dispatch();
+		void Collect();
+		void Finish(const int job);
+		void Fail(const int w);
+
+		const EventStore& events;
+		int nvars, nobj;
+		vector<Job> jobs;
+		deque<int> queue;
+		vector<Worker> workers;
+		vector<int> pending, first;
+		deque<int> completed;
+		long done, restarts;
+		double started, busy;
+};
+
+#endif  // _FARM_H_
@@ -1,6 +1,6 @@
 // --------------------------------------------------------------
 //    NETSCORE Version 2
-//    global.cpp -- Implementation of global variables and functions
+//    global.cpp -- Implementation of the model context and global functions
 //    2009-2011 (c) Eduardo Ibanez
 // --------------------------------------------------------------
 
@@ -11,15 +11,64 @@ using namespace std;
 #include <cstring>
 #include <time.h>
 #include <math.h>
-extern int outputLevel;
+#include <vector>
+#include "global.h"
 time_t startTime, endTime;
 
+// Default values of the model parameters
+ModelContext::ModelContext() :
+	SName(""), SLength(0), SFullLength(0), StepHours(0), RepPeriods(0), PeriodWeight(0), PeriodRep(0),
+	useDCflow(false), useBenders(false), useCompactNames(false), useBinaryModel(false), useRegions(false), useTextIndices(false),
+	useDebugFiles(false), useComponents(false), useCutPool(false), useScreening(false),
+	DefStep(""), StorageCode("S"), DCCode(""), TransStep(""), TransDummy("XT"), TransCoal(""), BendersMethod("kelley"),
+	TransInfra(0), TransComm(0), SustObj(0), SustMet(0), outputLevel(2), BendersThreads(1), SolverThreads(0), CutMaxAge(5), CutSlack(1e-6),
+	StabFactor(0.5), TrustRadius(0.5), StabGap(0.01),
+	OpCostScale(1), InvCostScale(1), LimitScale(1),
+	Npopsize(20), Nngen(200), Nobj(1), Nevents(0),
+	Npcross_real("0.75"), Npmut_real("0.2"), Neta_c("7"), Neta_m("20"), Npcross_bin("0.4"), Npmut_bin("0.7"), Nstages("2"), NevalOrder("population"), NbasisCache(0), Nworkers(0), Nthreads(1),
+	Nislands(2), NmigInterval(5), Nmigrants(2), Nmigration("ring"), NmigSelect("best"), NevalCache(false), NpostDetail(true), Nprune(false),
+	Np_start(0.5),
+	ArcProp(0), ArcDefault(0), NodeProp(0), NodeDefault(0), NodePropOffset(0), ArcPropOffset(0),
+	IdxNode(this), IdxUd(this), IdxRm(this), IdxArc(this), IdxInv(this), IdxCap(this), IdxUb(this), IdxEm(this), IdxDc(this), IdxNsga(this) {}
+
+// Copy all the members, the indices are bound to this context
+void ModelContext::Assign(const ModelContext& rhs) {
+	if (this == &rhs) return;
+	SName = rhs.SName; SLength = rhs.SLength; SFullLength = rhs.SFullLength; StepHours = rhs.StepHours;
+	RepPeriods = rhs.RepPeriods; PeriodWeight = rhs.PeriodWeight; PeriodRep = rhs.PeriodRep;
+	useDCflow = rhs.useDCflow; useBenders = rhs.useBenders; useCompactNames = rhs.useCompactNames; useBinaryModel = rhs.useBinaryModel;
+	useRegions = rhs.useRegions; useTextIndices = rhs.useTextIndices; useDebugFiles = rhs.useDebugFiles; useComponents = rhs.useComponents;
+	useCutPool = rhs.useCutPool; useScreening = rhs.useScreening;
+	DefStep = rhs.DefStep; StorageCode = rhs.StorageCode; DCCode = rhs.DCCode; TransStep = rhs.TransStep; TransDummy = rhs.TransDummy;
+	TransCoal = rhs.TransCoal; BendersMethod = rhs.BendersMethod;
+	TransInfra = rhs.TransInfra; TransComm = rhs.TransComm; SustObj = rhs.SustObj; SustMet = rhs.SustMet;
+	outputLevel = rhs.outputLevel; BendersThreads = rhs.BendersThreads; SolverThreads = rhs.SolverThreads; CutMaxAge = rhs.CutMaxAge;
+	CutSlack = rhs.CutSlack; StabFactor = rhs.StabFactor; TrustRadius = rhs.TrustRadius; StabGap = rhs.StabGap;
+	OpCostScale = rhs.OpCostScale; InvCostScale = rhs.InvCostScale; LimitScale = rhs.LimitScale;
+	Npopsize = rhs.Npopsize; Nngen = rhs.Nngen; Nobj = rhs.Nobj; Nevents = rhs.Nevents;
+	Npcross_real = rhs.Npcross_real; Npmut_real = rhs.Npmut_real; Neta_c = rhs.Neta_c; Neta_m = rhs.Neta_m;
+	Npcross_bin = rhs.Npcross_bin; Npmut_bin = rhs.Npmut_bin; Nstages = rhs.Nstages; NevalOrder = rhs.NevalOrder;
+	NbasisCache = rhs.NbasisCache; Nworkers = rhs.Nworkers; Nthreads = rhs.Nthreads;
+	Nislands = rhs.Nislands; NmigInterval = rhs.NmigInterval; Nmigrants = rhs.Nmigrants;
+	Nmigration = rhs.Nmigration; NmigSelect = rhs.NmigSelect;
+	NevalCache = rhs.NevalCache; NpostDetail = rhs.NpostDetail; Nprune = rhs.Nprune; Np_start = rhs.Np_start;
+	ArcProp = rhs.ArcProp; ArcDefault = rhs.ArcDefault; NodeProp = rhs.NodeProp; NodeDefault = rhs.NodeDefault;
+	NodePropOffset = rhs.NodePropOffset; ArcPropOffset = rhs.ArcPropOffset;
+	
+	IdxNames = rhs.IdxNames;
+	Index* to[] = {&IdxNode, &IdxUd, &IdxRm, &IdxArc, &IdxInv, &IdxCap, &IdxUb, &IdxEm, &IdxDc, &IdxNsga};
+	const Index* from[] = {&rhs.IdxNode, &rhs.IdxUd, &rhs.IdxRm, &rhs.IdxArc, &rhs.IdxInv, &rhs.IdxCap, &rhs.IdxUb, &rhs.IdxEm, &rhs.IdxDc, &rhs.IdxNsga};
+	for (int i = 0; i < 10; ++i) {
+		*to[i] = *from[i];
+		to[i]->Context = this;
+	}
+}
+
 // Print error messages
 void printError(const string& selector, const char* fileinput) {
-	if (selector == "warning") {
-		if (outputLevel < 3)
-			cout << "\tWarning: File '" << fileinput << "' not found!\n";
-	} else
+	if (selector == "warning")
+		cout << "\tWarning: File '" << fileinput << "' not found!\n";
+	else
 		cout << "\tERROR: File '" << fileinput << "' not found!\n";
 }
 
@@ -56,6 +105,20 @@ void printHeader(const string& selector) {
 		cout << "|         Post-processing module         |" << endl;
 		cout << "==========================================" << endl;
 		printHeader("time");
+	} else if (selector == "pipeline") {
+		cout << endl;
+		cout << "==========================================" << endl;
+		cout << "|  NETSCORE-21 Long-term planning model  |" << endl;
+		cout << "|      Pre-processing and optimizing     |" << endl;
+		cout << "==========================================" << endl;
+		printHeader("time");
+	} else if (selector == "sweep") {
+		cout << endl;
+		cout << "==========================================" << endl;
+		cout << "|  NETSCORE-21 Long-term planning model  |" << endl;
+		cout << "|      Sweep of parameter variants       |" << endl;
+		cout << "==========================================" << endl;
+		printHeader("time");
 	} else if (selector == "postnsga") {
 		cout << endl;
 		cout << "==========================================" << endl;
@@ -84,6 +147,20 @@ void printHeader(const string& selector) {
 		cout << "|         NSGA-II parallel solver        |" << endl;
 		cout << "==========================================" << endl;
 		printHeader("time");
+	} else if (selector == "nsga-async") {
+		cout << endl;
+		cout << "==========================================" << endl;
+		cout << "|  NETSCORE-21 Long-term planning model  |" << endl;
+		cout << "|       NSGA-II asynchronous solver      |" << endl;
+		cout << "==========================================" << endl;
+		printHeader("time");
+	} else if (selector == "nsga-islands") {
+		cout << endl;
+		cout << "==========================================" << endl;
+		cout << "|  NETSCORE-21 Long-term planning model  |" << endl;
+		cout << "|          NSGA-II island solver         |" << endl;
+		cout << "==========================================" << endl;
+		printHeader("time");
 	} else if (selector == "completed") {
 		cout << endl;
 		printHeader("elapsed");
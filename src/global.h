@@ -1,6 +1,6 @@
 // --------------------------------------------------------------
 //    NETSCORE Version 2
-//    global.h -- Definition of global variables and functions
+//    global.h -- Definition of the model context and global functions
 //    2009-2011 (c) Eduardo Ibanez
 // --------------------------------------------------------------
 
@@ -8,6 +8,7 @@
 #define _GLOBAL_H_
 
 #include <string>
+#include <vector>
 #include <sstream>
 #include "step.h"
 #include "index.h"
@@ -16,18 +17,54 @@
 typedef vector<string> VectorStr;
 typedef vector<VectorStr> MatrixStr;
 
-// Global variables
-extern string SName;
-extern Step SLength;
-extern bool useDCflow, useBenders;
-extern string DefStep, StorageCode, DCCode, TransStep, TransDummy, TransCoal;
-extern int Npopsize, Nngen, Nobj, Nevents;
-extern string Npcross_real, Npmut_real, Neta_c, Neta_m, Npcross_bin, Npmut_bin, Nstages;
-extern double Np_start;
-extern vector<string> ArcProp, ArcDefault, NodeProp, NodeDefault, TransInfra, TransComm, StepHours, SustObj, SustMet;
-extern int NodePropOffset, ArcPropOffset, outputLevel;
-// Store indices to recover data after optimization
-extern Index IdxNode, IdxUd, IdxRm, IdxArc, IdxInv, IdxCap, IdxUb, IdxEm, IdxDc, IdxNsga;
+// Model state: step definition, parameters, properties and indices of one case. It is passed
+// explicitly to the functions that need it, so that several cases can share the same process
+struct ModelContext {
+	ModelContext();
+	
+	// Copies all the members of another context (e.g., a variant built apart), the indices refer to this one
+	void Assign(const ModelContext& rhs);
+	
+	// Steps
+	string SName;
+	Step SLength, SFullLength;
+	vector<string> StepHours;
+	int RepPeriods;
+	vector<double> PeriodWeight;
+	vector<int> PeriodRep;     // Representative period of each original period (by group)
+	
+	// General parameters
+	bool useDCflow, useBenders, useCompactNames, useBinaryModel, useRegions, useTextIndices, useDebugFiles, useComponents, useCutPool, useScreening;
+	string DefStep, StorageCode, DCCode, TransStep, TransDummy, TransCoal, BendersMethod;
+	vector<string> TransInfra, TransComm, SustObj, SustMet;
+	int outputLevel, BendersThreads, SolverThreads, CutMaxAge;
+	double CutSlack, StabFactor, TrustRadius, StabGap;
+	
+	// Multipliers of costs and sustainability limits (used for sensitivity sweeps)
+	double OpCostScale, InvCostScale, LimitScale;
+	
+	// Resiliency and NSGA-II parameters
+	int Npopsize, Nngen, Nobj, Nevents;
+	string Npcross_real, Npmut_real, Neta_c, Neta_m, Npcross_bin, Npmut_bin, Nstages, NevalOrder;
+	int NbasisCache, Nworkers, Nthreads;
+	int Nislands, NmigInterval, Nmigrants;
+	string Nmigration, NmigSelect;
+	bool NevalCache, NpostDetail, Nprune;
+	double Np_start;
+	
+	// Node and arc properties and their default values
+	vector<string> ArcProp, ArcDefault, NodeProp, NodeDefault;
+	int NodePropOffset, ArcPropOffset;
+	
+	// Store indices to recover data after optimization
+	IndexDict IdxNames;
+	Index IdxNode, IdxUd, IdxRm, IdxArc, IdxInv, IdxCap, IdxUb, IdxEm, IdxDc, IdxNsga;
+	
+	private:
+		// Indices keep a pointer to their context, so it is not copied implicitly (see Assign)
+		ModelContext(const ModelContext& rhs);
+		ModelContext& operator=(const ModelContext& rhs);
+};
 
 // Print error messages
 void printError(const string& selector, const char* fileinput);
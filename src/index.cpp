@@ -10,18 +10,40 @@ using namespace std;
 #include <string>
 #include <vector>
 #include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "global.h"
 #include "index.h"
+#include "aggregate.h"
+
+// Find the reference of a name in the dictionary, adding it if necessary
+int IndexDict::Find(const string& newname) {
+	map<string, int>::iterator it = Positions.find(newname);
+	if (it != Positions.end()) return it->second;
+	Positions[newname] = Names.size();
+	Names.push_back(newname);
+	return Names.size() - 1;
+}
+
+void IndexDict::Clear() {
+	Names.clear();
+	Positions.clear();
+}
 
 // Contructors and destructor for the Index class
-Index::Index() :
-	position(0), column(0), year(0), name(0) { start=0; size=0; }
+Index::Index(ModelContext* context) :
+	position(0), column(0), year(0), name(0), Context(context) { start=0; size=0; }
 
 Index::Index(const Index& rhs) :
 	position(rhs.position),
 	column(rhs.column),
 	year(rhs.year),
-	name(rhs.name) { start=rhs.start; size=rhs.size; }
+	name(rhs.name),
+	Context(rhs.Context) { start=rhs.start; size=rhs.size; }
 
 Index::~Index() {}
 
@@ -30,6 +52,7 @@ Index& Index::operator=(const Index& rhs) {
 	column = rhs.column,
 	year = rhs.year,
 	name = rhs.name;
+	Context = rhs.Context;
 	start = rhs.start;
 	size = rhs.size;
 	return *this;
@@ -40,12 +63,12 @@ void Index::Add(const int newpos, const int newcol, const int newyear, const str
 	position.push_back(newpos);
 	column.push_back(newcol);
 	year.push_back(newyear);
-	name.push_back(newname);
+	name.push_back(Context->IdxNames.Find(newname));
 	++size;
 }
 
 void Index::Add(const int newpos, const Step& newcol, const string& newname) {
-	Add(newpos, Step2Col(newcol), newcol[0], newname);
+	Add(newpos, Step2Col(*Context, newcol), newcol[0], newname);
 }
 
 // Write a file
@@ -56,14 +79,19 @@ void Index::WriteFile(const char* fileinput) const {
 		myfile << position[i] << "\n";
 		myfile << column[i] << "\n";
 		myfile << year[i] << "\n";
-		myfile << name[i] << "\n";
+		myfile << Name(i) << "\n";
 	}
 	myfile.close();
 }
 
+// Name of an element
+const string& Index::Name(const int i) const {
+	return Context->IdxNames.Names[name[i]];
+}
+
 // Read a file
-Index ReadFile(const char* fileinput) {
-	Index TempIndex;
+Index ReadFile(ModelContext& ctx, const char* fileinput) {
+	Index TempIndex(&ctx);
 	char line[200];
 	FILE *file = fopen(fileinput, "r");
 	
@@ -90,24 +118,140 @@ Index ReadFile(const char* fileinput) {
 	return TempIndex;
 }
 
-// Loads all necessary index files in memory
-void ImportIndices() {
-	IdxNode = ReadFile("prepdata/idx_node.csv");
-	IdxUd   = ReadFile("prepdata/idx_ud.csv");
-	IdxRm   = ReadFile("prepdata/idx_rm.csv");
-	IdxArc  = ReadFile("prepdata/idx_arc.csv");
-	IdxInv  = ReadFile("prepdata/idx_inv.csv");
-	IdxNsga = ReadFile("prepdata/idx_nsga.csv");
-	IdxCap  = ReadFile("prepdata/idx_cap.csv");
-	IdxUb   = ReadFile("prepdata/idx_ub.csv");
-	IdxEm   = ReadFile("prepdata/idx_em.csv");
-	IdxDc   = ReadFile("prepdata/idx_dc.csv");
+// All the indices in the order they are stored in the bundle
+void IndexList(ModelContext& ctx, vector<Index*>& output) {
+	output.clear();
+	output.push_back(&ctx.IdxNode); output.push_back(&ctx.IdxUd); output.push_back(&ctx.IdxRm);
+	output.push_back(&ctx.IdxArc); output.push_back(&ctx.IdxInv); output.push_back(&ctx.IdxNsga);
+	output.push_back(&ctx.IdxCap); output.push_back(&ctx.IdxUb); output.push_back(&ctx.IdxEm);
+	output.push_back(&ctx.IdxDc);
+}
+
+// Write all the indices in a binary file. Format (ints): "NPIX", number of indices, number of names,
+// size of the names, name offsets, names (padded to 4 bytes) and, for each index, its size followed
+// by the columns position, column, year and name
+void WriteIndexBundle(ModelContext& ctx, const char* fileinput) {
+	vector<Index*> List;
+	IndexList(ctx, List);
+	
+	const vector<string>& Names = ctx.IdxNames.Names;
+	vector<int> offsets(1, 0);
+	string blob = "";
+	for (unsigned int i = 0; i < Names.size(); ++i) {
+		blob += Names[i];
+		offsets.push_back(blob.size());
+	}
+	int header[3] = {(int) List.size(), (int) Names.size(), (int) blob.size()};
+	while (blob.size() % sizeof(int) != 0) blob += '\0';
+	
+	ofstream myfile(fileinput, ios::out | ios::binary);
+	myfile.write("NPIX", 4);
+	myfile.write((const char*) header, sizeof(header));
+	myfile.write((const char*) &offsets[0], offsets.size() * sizeof(int));
+	myfile.write(blob.data(), blob.size());
+	for (unsigned int k = 0; k < List.size(); ++k) {
+		Index& Idx = *List[k];
+		myfile.write((const char*) &Idx.size, sizeof(int));
+		if (Idx.size == 0) continue;
+		myfile.write((const char*) &Idx.position[0], Idx.size * sizeof(int));
+		myfile.write((const char*) &Idx.column[0], Idx.size * sizeof(int));
+		myfile.write((const char*) &Idx.year[0], Idx.size * sizeof(int));
+		myfile.write((const char*) &Idx.name[0], Idx.size * sizeof(int));
+	}
+	myfile.close();
+}
+
+// Map the binary file in memory and copy its columns into the indices (false if it is not available)
+bool ReadIndexBundle(ModelContext& ctx, const char* fileinput) {
+	int fd = open(fileinput, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat info;
+	if ((fstat(fd, &info) != 0) || (info.st_size < 16)) {
+		close(fd);
+		return false;
+	}
+	void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) return false;
 	
-	IdxCap.start = 0;
-	IdxInv.start = IdxCap.start + IdxCap.size;
-	IdxEm.start  = IdxInv.start + IdxInv.size;
-	IdxRm.start  = IdxEm.start + IdxEm.size;
-	IdxArc.start = IdxRm.start + IdxRm.size;
-	IdxUd.start  = IdxArc.start + IdxArc.size;
-	IdxDc.start  = IdxUd.start + IdxUd.size;
+	const char* base = (const char*) data;
+	const int* header = (const int*) (base + 4);
+	vector<Index*> List;
+	IndexList(ctx, List);
+	bool valid = (memcmp(base, "NPIX", 4) == 0) && (header[0] == (int) List.size());
+	
+	// Every section must be inside the file (a truncated or stale bundle), checked before reading
+	size_t length = info.st_size, end = 16;
+	int nnames = header[1], nbytes = header[2];
+	const int* offsets = header + 3;
+	if (valid)
+		valid = (nnames >= 0) && (nbytes >= 0) && ((length - end) / sizeof(int) >= (size_t) nnames + 1);
+	if (valid) {
+		end += (nnames + 1) * sizeof(int);
+		valid = (offsets[0] == 0) && (offsets[nnames] == nbytes) && ((length - end) >= (size_t) nbytes);
+		for (int i = 0; valid && (i < nnames); ++i)
+			valid = (offsets[i] <= offsets[i+1]);
+		end += (nbytes + sizeof(int) - 1) / sizeof(int) * sizeof(int);
+	}
+	for (unsigned int k = 0; valid && (k < List.size()); ++k) {
+		valid = (end + sizeof(int) <= length);
+		if (!valid) break;
+		int size = *(const int*) (base + end);
+		end += sizeof(int);
+		valid = (size >= 0) && ((length - end) / (4 * sizeof(int)) >= (size_t) size);
+		end += 4 * sizeof(int) * (size_t) size;
+	}
+	
+	if (valid) {
+		// Dictionary of names
+		const char* blob = (const char*) (offsets + nnames + 1);
+		ctx.IdxNames.Clear();
+		for (int i = 0; i < nnames; ++i)
+			ctx.IdxNames.Find(string(blob + offsets[i], offsets[i+1] - offsets[i]));
+		
+		// Columns of each index
+		const int* ptr = (const int*) (blob + (nbytes + sizeof(int) - 1) / sizeof(int) * sizeof(int));
+		for (unsigned int k = 0; k < List.size(); ++k) {
+			Index& Idx = *List[k];
+			Idx = Index(&ctx);
+			Idx.size = *ptr++;
+			Idx.position.assign(ptr, ptr + Idx.size); ptr += Idx.size;
+			Idx.column.assign(ptr, ptr + Idx.size); ptr += Idx.size;
+			Idx.year.assign(ptr, ptr + Idx.size); ptr += Idx.size;
+			Idx.name.assign(ptr, ptr + Idx.size); ptr += Idx.size;
+		}
+	} else {
+		cout << "\tERROR: File '" << fileinput << "' is not a valid index bundle\n";
+	}
+	munmap(data, info.st_size);
+	return valid;
+}
+
+// Loads all necessary index files in memory (the binary bundle, or the text files if it is not available)
+void ImportIndices(ModelContext& ctx) {
+	if (!ReadIndexBundle(ctx, "prepdata/indices.bin")) {
+		ctx.IdxNode = ReadFile(ctx, "prepdata/idx_node.csv");
+		ctx.IdxUd   = ReadFile(ctx, "prepdata/idx_ud.csv");
+		ctx.IdxRm   = ReadFile(ctx, "prepdata/idx_rm.csv");
+		ctx.IdxArc  = ReadFile(ctx, "prepdata/idx_arc.csv");
+		ctx.IdxInv  = ReadFile(ctx, "prepdata/idx_inv.csv");
+		ctx.IdxNsga = ReadFile(ctx, "prepdata/idx_nsga.csv");
+		ctx.IdxCap  = ReadFile(ctx, "prepdata/idx_cap.csv");
+		ctx.IdxUb   = ReadFile(ctx, "prepdata/idx_ub.csv");
+		ctx.IdxEm   = ReadFile(ctx, "prepdata/idx_em.csv");
+		ctx.IdxDc   = ReadFile(ctx, "prepdata/idx_dc.csv");
+	}
+	SetIndexStarts(ctx);
+	ReadPeriodWeights(ctx, "prepdata/rep_periods.csv");
+}
+
+// Sets the position of the first variable of each index in the problems
+void SetIndexStarts(ModelContext& ctx) {
+	ctx.IdxCap.start = 0;
+	ctx.IdxInv.start = ctx.IdxCap.start + ctx.IdxCap.size;
+	ctx.IdxEm.start  = ctx.IdxInv.start + ctx.IdxInv.size;
+	ctx.IdxRm.start  = ctx.IdxEm.start + ctx.IdxEm.size;
+	ctx.IdxArc.start = ctx.IdxRm.start + ctx.IdxRm.size;
+	ctx.IdxUd.start  = ctx.IdxArc.start + ctx.IdxArc.size;
+	ctx.IdxDc.start  = ctx.IdxUd.start + ctx.IdxUd.size;
 }
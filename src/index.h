@@ -7,10 +7,24 @@
 #ifndef _INDEX_H_
 #define _INDEX_H_
 
+#include <map>
+
+struct ModelContext;
+
+// Dictionary of names shared by all the indices of a model (names are repeated for each step)
+class IndexDict {
+	public:
+		int Find(const string& name);
+		void Clear();
+		
+		vector<string> Names;
+		map<string, int> Positions;
+};
+
 // Declare class type to hold index information
 class Index {
 	public:
-		Index();
+		Index(ModelContext* context = NULL);
 		Index(const Index& rhs);
 		~Index();
 		Index& operator=(const Index& rhs);
@@ -18,16 +32,23 @@ class Index {
 		void Add(const int newpos, const int newcol, const int newyear, const string& newname);
 		void Add(const int newpos, const Step& newcol, const string& newname);
 		void WriteFile(const char* fileinput) const;
+		const string& Name(const int i) const;
 		
 		// Variables
 		int start, size;
 		vector<int> position;
 		vector<int> column;
 		vector<int> year;
-		vector<string> name;
+		vector<int> name;     // Reference to the dictionary of names of the context
+		ModelContext* Context;
 };
 
-Index ReadFile(const char* fileinput);
-void ImportIndices();
+Index ReadFile(ModelContext& ctx, const char* fileinput);
+void ImportIndices(ModelContext& ctx);
+void SetIndexStarts(ModelContext& ctx);
+
+// All the indices in a single binary file (with a dictionary of names)
+void WriteIndexBundle(ModelContext& ctx, const char* fileinput);
+bool ReadIndexBundle(ModelContext& ctx, const char* fileinput);
 
 #endif  // _INDEX_H_
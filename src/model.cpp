@@ -0,0 +1,885 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    model.cpp -- Implementation of the model building functions
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+using namespace std;
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include "global.h"
+#include "node.h"
+#include "arc.h"
+#include "index.h"
+#include "read.h"
+#include "mps.h"
+#include "aggregate.h"
+#include "event.h"
+#include "model.h"
+
+// Energy loads of a transportation arc, resolved once for each arc: code of the energy node, number
+// of levels of its step and coefficients in the same columns as 'data/arcs_TransEnergy.csv'
+struct TransCoupling {
+	string Code;
+	unsigned int Depth;
+	vector<double> Coef;
+};
+
+// Write DC Power flow columns in the MPS file
+vector<string> DCFlowColumns(const ModelContext& ctx, const vector<Node>& v, const vector<Arc>& w) {
+	vector<string> temp_output(ctx.SLength[0]+1, "");
+	for (unsigned int i = 0; i < v.size(); ++i) {
+		for (unsigned int j = 0; j < w.size(); ++j) {
+			if (w[j].Get("From") < w[j].Get("To")) {
+				if (v[i].Get("Code") == (w[j].Get("From") + w[j].Get("FromStep"))) {
+					temp_output[ v[i].Time() ] += "    th" + v[i].Get("Code") + " dcpf" + w[j].Get("Code") + " " + w[j].Get("Suscep") + "\n";
+				} else if (v[i].Get("Code") == (w[j].Get("To") + w[j].Get("ToStep"))) {
+					temp_output[ v[i].Time() ] += "    th" + v[i].Get("Code") + " dcpf" + w[j].Get("Code") + " -" + w[j].Get("Suscep") + "\n";
+				}
+			}
+		}
+	}
+	return temp_output;
+}
+
+
+// Given a matrix of values, finds the row that fits best to a code. It tries to match the whole code, two or one letters.
+int FindCode(const string& mystr, const MatrixStr mymatrix) {
+	int output = -1, one_char = -1, two_char = -1, k = 0;
+	
+	if (mymatrix.size() > 0) {
+		while ((k < mymatrix.size()) && (output == -1)) {
+			if (mystr == mymatrix[k][0]) output = k;
+			else if (mystr.substr(0,1) == mymatrix[k][0]) one_char = k;
+			else if (mystr.substr(0,2) == mymatrix[k][0]) two_char = k;
+			k++;
+		}
+	}
+	if (output == -1) {
+		if (one_char != -1) output = one_char;
+		if (two_char != -1) output = two_char;
+	}
+	
+	return output;
+}
+
+// This function has the same porpuse, but prepared for arcs
+int FindCode(const string& strfrom, const string& strto, const MatrixStr mymatrix) {
+	int output = -1, one_one = -1, one_two = -1, one_all = -1, two_two = -1, two_all = -1, k = 0;
+	int zero_one = -1, zero_two = -1, zero_all = -1;
+	
+	if (mymatrix.size() > 0) {
+		while ((k < mymatrix.size()) && (output == -1)) {
+			if (strfrom == mymatrix[k][0]) {
+				if (strto == mymatrix[k][1]) output = k;
+				else if (strto.substr(0,1) == mymatrix[k][1]) one_all = k;
+				else if (strto.substr(0,2) == mymatrix[k][1]) two_all = k;
+				else if (mymatrix[k][1] == "") zero_all = k;
+			} else if (strfrom.substr(0,2) == mymatrix[k][0]) {
+				if (strto == mymatrix[k][1]) two_all = k;
+				else if (strto.substr(0,1) == mymatrix[k][1]) one_two = k;
+				else if (strto.substr(0,2) == mymatrix[k][1]) two_two = k;
+				else if (mymatrix[k][1] == "") zero_two = k;
+			} else if (strfrom.substr(0,1) == mymatrix[k][0]) {
+				if (strto == mymatrix[k][1]) one_all = k;
+				else if (strto.substr(0,1) == mymatrix[k][1]) one_one = k;
+				else if (strto.substr(0,2) == mymatrix[k][1]) one_two = k;
+				else if (mymatrix[k][1] == "") zero_one = k;
+			} else if (mymatrix[k][0] == "") {
+				if (strto == mymatrix[k][1]) zero_all = k;
+				else if (strto.substr(0,1) == mymatrix[k][1]) zero_one = k;
+				else if (strto.substr(0,2) == mymatrix[k][1]) zero_two = k;
+			}
+			k++;
+		}
+	}
+	if (output == -1) {
+		if (zero_one != -1) output = zero_one;
+		if (zero_two != -1) output = zero_two;
+		if (zero_all != -1) output = zero_all;
+		if (one_one != -1) output = one_one;
+		if (one_two != -1) output = one_two;
+		if (one_all != -1) output = one_all;
+		if (two_two != -1) output = two_two;
+		if (two_all != -1) output = two_all;
+	}
+	
+	return output;
+}
+
+// Shortcuts for nodes and arcs
+int FindCode(const Node& mynode, const MatrixStr mymatrix) {
+	return FindCode(mynode.Get("ShortCode"), mymatrix);
+}
+
+int FindCode(const Arc& myarc, const MatrixStr mymatrix) {
+	int output = -1;
+	// Look for properties for the arc in the opposite direction
+	Arc myarc2(myarc, true);
+	if (myarc.isBidirect() || myarc.isTransport()) {
+		int code1 = FindCode(myarc.Get("From"), myarc.Get("To"), mymatrix);
+		int code2 = FindCode(myarc2.Get("From"), myarc2.Get("To"), mymatrix);
+		output = (code1 >= code2) ? code1 : code2;
+	} else {
+		output = FindCode(myarc.Get("From"), myarc.Get("To"), mymatrix);
+	}
+	return output;
+}
+
+// Reports the independent components of each problem (the single problem, or each Benders subproblem)
+// and the nodes that belong to them, which shows where the model splits naturally
+void ReportComponents(const ModelContext& ctx, const vector<LPBlock>& Blocks, const vector<Node>& Nodes, const bool writeFiles) {
+	int nyears = ctx.SLength[0];
+	ofstream compfile;
+	if (writeFiles) {
+		compfile.open("prepdata/components.csv");
+		compfile << "% Problem,Component,Rows,Columns,Nodes" << endl;
+	}
+	
+	cout << "  Independent components:";
+	for (int i = ctx.useBenders ? 1 : 0; i <= (ctx.useBenders ? nyears : 0); ++i) {
+		int b = ctx.useBenders ? i+1 : 0;
+		const LPBlock& structure = (Blocks[b].templ >= 0) ? Blocks[Blocks[b].templ] : Blocks[b];
+		vector<int> rowcomp, colcomp;
+		int count = structure.Components(rowcomp, colcomp);
+		cout << " " << count;
+		if (!writeFiles) continue;
+		
+		// Nodal rows follow the sustainability (and peak) rows, in the same order as the nodes
+		int row = ctx.useBenders ? ctx.SustMet.size() : ctx.IdxEm.size + ctx.IdxRm.size;
+		vector< vector<string> > names(count);
+		for (unsigned int k = 0; k < Nodes.size(); ++k) {
+			if (ctx.useBenders && (Nodes[k].Time() != i)) continue;
+			vector<string>& list = names[rowcomp[row++]];
+			string code = Nodes[k].Get("ShortCode");
+			if (find(list.begin(), list.end(), code) == list.end()) list.push_back(code);
+		}
+		
+		vector<int> rows(count, 0), cols(count, 0);
+		for (unsigned int k = 0; k < rowcomp.size(); ++k) ++rows[rowcomp[k]];
+		for (unsigned int j = 0; j < colcomp.size(); ++j) ++cols[colcomp[j]];
+		for (int c = 0; c < count; ++c) {
+			compfile << i << "," << c << "," << rows[c] << "," << cols[c] << ",";
+			for (unsigned int n = 0; n < names[c].size(); ++n)
+				compfile << ((n > 0) ? " " : "") << names[c][n];
+			compfile << endl;
+		}
+	}
+	cout << ((ctx.useBenders) ? " (subproblems)" : "") << endl;
+	if (writeFiles) compfile.close();
+}
+
+// Reads the data of a case and builds its optimization problems (see model.h)
+void BuildModel(ModelContext& ctx, vector<LPBlock>* Problems, EventStore& Events, const bool writeFiles) {
+	// Data is read with the original steps, representative periods are formed afterwards
+	ctx.SLength = ctx.SFullLength;
+	
+	// Variables to store information
+	vector<Node> ListNodes, Nodes, ListDCNodes;
+	vector<Arc> ListArcs, Arcs, ListDCArcs;
+	MatrixStr NStep(0), ATransEnergy(0), SustLimits(0);
+	vector<MatrixStr> NVectorProp(0), AVectorProp(0);
+	vector<int> NVectorIndex(ctx.NodeProp.size()-ctx.NodePropOffset, -1), AVectorIndex(ctx.ArcProp.size()-ctx.ArcPropOffset, -1);
+	
+	cout << "- Reading list of nodes...\n";
+	ListNodes = ReadListNodes(ctx, "data/nodes_List.csv");
+	cout << "- Reading node data...\n";
+	NStep = ReadStep(ctx, "data/nodes_Step.csv");
+	for (unsigned int t=ctx.NodePropOffset; t < ctx.NodeProp.size(); ++t) {
+		string file_name = "data/nodes_" + ctx.NodeProp[t] + ".csv";
+		NVectorProp.push_back(ReadProperties(ctx, file_name.c_str(), ctx.NodeDefault[t], 1));
+	}
+	
+	cout << "- Reading list of arcs...\n";
+	ListArcs = ReadListArcs(ctx, "data/arcs_List.csv");
+	cout << "- Reading arc data...\n";
+	ATransEnergy = ReadProperties(ctx, "data/arcs_TransEnergy.csv", "X", 2);
+	for (unsigned int t=ctx.ArcPropOffset; t < ctx.ArcProp.size(); ++t) {
+		string file_name;
+		if (t < ctx.ArcProp.size() - ctx.Nevents) {
+			// Regular properties
+			file_name = "data/arcs_" + ctx.ArcProp[t] + ".csv";
+		} else {
+			// Resiliency properties
+			file_name = "data/events/" + ctx.ArcProp[t] + ".csv";
+		}
+		AVectorProp.push_back(ReadProperties(ctx, file_name.c_str(), ctx.ArcDefault[t], 2));
+	}
+	
+	if (ctx.useRegions) {
+		cout << "- Aggregating nodes into regions...\n";
+		MatrixStr Regions = ReadStep(ctx, "data/nodes_Region.csv");
+		AggregateRegions(ctx, ListNodes, ListArcs, NStep, NVectorProp, AVectorProp, Regions, writeFiles ? "prepdata/idx_region.csv" : NULL);
+	}
+	
+	cout << "- Creating transportation network...\n";
+	ReadTrans(ctx, ListNodes, ListArcs, "data/trans_List.csv");
+	
+	cout << "- Reading sustainability constraints...\n";
+	SustLimits = ReadProperties(ctx, "data/sust_Limits.csv", "X", 1);
+	
+	if (ctx.RepPeriods > 0) {
+		cout << "- Selecting representative periods...\n";
+		vector<MatrixStr*> AggData(0);
+		vector<int> AggFields(0);
+		for (unsigned int t=0; t < NVectorProp.size(); ++t) {
+			AggData.push_back(&NVectorProp[t]);
+			AggFields.push_back(1);
+		}
+		for (unsigned int t=0; t < AVectorProp.size(); ++t) {
+			AggData.push_back(&AVectorProp[t]);
+			AggFields.push_back(2);
+		}
+		AggData.push_back(&ATransEnergy);
+		AggFields.push_back(2);
+		AggData.push_back(&SustLimits);
+		AggFields.push_back(1);
+		AggregatePeriods(ctx, AggData, AggFields, writeFiles ? "prepdata/rep_periods.csv" : NULL);
+	}
+	
+	// Expand nodes
+	for (unsigned int k=0; k < ListNodes.size(); ++k) {
+		// Print progress
+		cout << "\r- Expanding nodes... " << k+1 << " / " << ListNodes.size() << flush;
+		
+		int StepIndex = FindCode(ListNodes[k], NStep);
+		
+		// Identify the row containing data for each property
+		for (unsigned int t=0; t < NVectorIndex.size(); ++t)
+			NVectorIndex[t] = FindCode(ListNodes[k], NVectorProp[t]);
+		
+		// Copy step information
+		if (StepIndex >= 0) ListNodes[k].Set("Step", NStep[StepIndex][1]);
+		
+		if (ListNodes[k].Get("Step") == "") {
+			printError("nodestep", ListNodes[k].Get("ShortCode"));
+		} else {
+			// Use a temporary node to store information and cycle through steps
+			Step TempStep(ctx.SName.size(), 0);
+			for (unsigned int l = 0; l < ListNodes[k].Get("Step").size(); l++) TempStep[l] = 1;
+			
+			while (TempStep <= ctx.SLength) {
+				// Apply information
+				Node TempNode = ListNodes[k];
+				TempNode.Set("Step", Step2Str(ctx, TempStep));
+				TempNode.Set("StepLength", Step2Hours(ctx, TempStep));
+				int l = Step2Pos(ctx, TempStep) + 1;
+				TempNode.Set("Code", TempNode.Get("ShortCode") + Step2Str(ctx, TempStep));
+				
+				for (unsigned int t=0; t < NVectorIndex.size(); ++t) {
+					int tmp_index = NVectorIndex[t];
+					if (tmp_index >= 0) TempNode.Set(ctx.NodeProp[ctx.NodePropOffset + t], NVectorProp[t][tmp_index][l]);
+				}
+				
+				// Calculate demand if power demand is given
+				if ((TempNode.Get("Demand") == "0") && (TempNode.Get("DemandPower") != "X")) {
+					double step_length = TempNode.GetDouble("StepLength");
+					TempNode.Multiply("DemandPower", step_length);
+					TempNode.Set("Demand", TempNode.Get("DemandPower"));
+				} else if (ctx.RepPeriods > 0) {
+					TempNode.Multiply("Demand", StepWeight(ctx, TempStep));
+				}
+				
+				// Adjust peak demand with increase rate
+				double dem_rate = TempNode.GetDouble("DemandRate");
+				double peak_rate = TempNode.GetDouble("PeakPowerRate");
+				double dem_factor = 1, peak_factor = 1;
+				
+				if ((dem_rate != 0) || (peak_rate != 0)) {
+					for (unsigned int l = 1; l < TempStep[0]; ++l) {
+						dem_factor = dem_factor * (1 + dem_rate);
+						peak_factor = peak_factor * (1 + peak_rate);
+					}
+					TempNode.Multiply("Demand", dem_factor);
+					TempNode.Multiply("PeakPower", peak_factor);
+				}
+				
+				// Store node for later use
+				Nodes.push_back(TempNode);
+				if (TempNode.isDCflow()) {
+					ListDCNodes.push_back(TempNode);
+					ctx.IdxDc.Add(k, TempStep, TempNode.Get("ShortCode"));
+				}
+				
+				// Record indices to recover information
+				ctx.IdxNode.Add(k, TempStep, TempNode.Get("ShortCode"));
+				if (TempNode.Get("CostUD") != "X") {
+					ctx.IdxUd.Add(k, TempStep, TempNode.Get("ShortCode"));
+				}
+				if ((TempNode.Get("PeakPower") != "X") && TempNode.isFirstinYear()) {
+					Step temp2(ctx.SName.size(), 0);
+					temp2[0] = TempStep[0];
+					ctx.IdxRm.Add(k, temp2, TempNode.Get("ShortCode"));
+				}
+				
+				// Move to the next step
+				TempStep = NextStep(ctx, TempStep);
+			}
+		}
+	}
+	
+	
+	// Expand arcs
+	cout << endl;
+	for (unsigned int k = 0; k < ListArcs.size(); ++k) {
+		// Print progress
+		cout << "\r- Expanding arcs... " << k+1 << " / " << ListArcs.size() << flush;
+		
+		// Identify the row containing data for each property
+		int StepFromIndex = FindCode(ListArcs[k].Get("From"),NStep);
+		int StepToIndex = FindCode(ListArcs[k].Get("To"),NStep);
+		int TransEnergyIndex = FindCode(ListArcs[k].Get("From"), ATransEnergy);
+		for (unsigned int t=0; t < AVectorIndex.size(); ++t) {
+			AVectorIndex[t] = FindCode(ListArcs[k], AVectorProp[t]);
+		}
+		
+		// Recover step information
+		if (StepFromIndex >= 0) ListArcs[k].Set("FromStep", NStep[StepFromIndex][1]);
+		if (StepToIndex >= 0) ListArcs[k].Set("ToStep", NStep[StepToIndex][1]);
+		
+		// Check for a storage arc
+		bool isStorage = ListArcs[k].isStorage();
+		// Storage within representative periods (steps of the periods or shorter) is cyclic within each period.
+		// Its net change is carried between the original periods by the states of the storage (see Arc::LinkColumns)
+		bool isCyclic = isStorage && (ctx.RepPeriods > 0) && (ListArcs[k].Get("FromStep").size() >= ctx.SName.size()-1);
+		
+		if ((ListArcs[k].Get("FromStep") == "") && (ListArcs[k].Get("ToStep") == "")) {
+			printError("arcstep", ListArcs[k].Get("From") + "_" + ListArcs[k].Get("To"));
+		} else {
+			// Cycle through steps (more complicated here) to expand arcs
+			string TempArcStepCode = max(ListArcs[k].Get("FromStep"), ListArcs[k].Get("ToStep"));
+			
+			Step TempStep(ctx.SName.size()), TempFromStep(ctx.SName.size(), 0), TempToStep(ctx.SName.size(), 0);
+			Step NextFromStep(ctx.SName.size()), NextToStep(ctx.SName.size());
+			
+			for (unsigned int l = 0; l < ListArcs[k].Get("FromStep").size(); l++) TempFromStep[l] = 1;
+			for (unsigned int l = ListArcs[k].Get("FromStep").size(); l < ctx.SName.size(); l++) TempFromStep[l] = 0;
+			
+			if (isCyclic) {
+				TempToStep = CyclicStep(ctx, TempFromStep);
+			} else if (isStorage) {
+				TempToStep = NextStep(ctx, TempFromStep);
+			} else {
+				for (unsigned int l = 0; l < ListArcs[k].Get("ToStep").size(); l++) TempToStep[l] = 1;
+				for (unsigned int l = ListArcs[k].Get("ToStep").size(); l < ctx.SName.size(); l++) TempToStep[l] = 0;
+			}
+			
+			NextFromStep = (TempFromStep[0] == 1) ? NextStep(ctx, TempFromStep) : NextStep(ctx, ctx.SLength);
+			NextToStep = (TempToStep[0] == 1) ? NextStep(ctx, TempToStep) : NextStep(ctx, ctx.SLength);
+			
+			TempStep = ((TempFromStep < TempToStep) && !isStorage) ? TempToStep : TempFromStep;
+			
+			// Find the shortest step, to assign it as a default for 'InvStep'
+			string TempStepStr = (TempFromStep < TempToStep) ? ListArcs[k].Get("ToStep") : ListArcs[k].Get("FromStep");
+			
+			// Loads on energy nodes (consecutive rows with the same code as the first match)
+			vector<TransCoupling> Couplings;
+			for (int r = TransEnergyIndex; (r >= 0) && (r < ATransEnergy.size()); ++r) {
+				if ((r > TransEnergyIndex) && (ListArcs[k].Get("From") != ATransEnergy[r][0]))
+					break;
+				TransCoupling Coupling;
+				Coupling.Code = ATransEnergy[r][1];
+				int LoadIndex = FindCode(Coupling.Code, NStep);
+				Coupling.Depth = (LoadIndex >= 0) ? NStep[LoadIndex][1].size() : ctx.DefStep.size();
+				Coupling.Coef.assign(ATransEnergy[r].size(), 0);
+				for (unsigned int c = 2; c < ATransEnergy[r].size(); ++c)
+					Coupling.Coef[c] = atof(ATransEnergy[r][c].c_str());
+				Couplings.push_back(Coupling);
+			}
+			
+			while ((TempStep <= ctx.SLength) && (TempToStep <= ctx.SLength)) {
+				// Apply information
+				Arc TempArc = ListArcs[k];
+				int l = Step2Pos(ctx, TempStep) + 2;
+				TempArc.Set("FromStep", Step2Str(ctx, TempFromStep));
+				TempArc.Set("ToStep", Step2Str(ctx, TempToStep));
+				TempArc.Set("StepLength", Step2Hours(ctx, TempStep));
+				
+				if (TempArc.isTransport() && (TempArc.Get("TransInfr") == ""))
+					TempArc.Set("Code", TempArc.Get("From") + Step2Str(ctx, TempFromStep));
+				else
+					TempArc.Set("Code", TempArc.Get("From") + Step2Str(ctx, TempFromStep) + "_" + TempArc.Get("To") + Step2Str(ctx, TempToStep));
+				
+				for (unsigned int t=0; t < AVectorIndex.size(); ++t) {
+					int tmp_index = AVectorIndex[t];
+					if (tmp_index >= 0) TempArc.Set(ctx.ArcProp[ctx.ArcPropOffset + t], AVectorProp[t][tmp_index][l]);
+				}
+				
+				// Is there a load on an energy node? Only the steps change within the arc
+				for (unsigned int c = 0; c < Couplings.size(); ++c) {
+					const TransCoupling& Load = Couplings[c];
+					Step LoadStep = TempStep;
+					if (Load.Depth <= TempArcStepCode.size()) {
+						for (unsigned int m = Load.Depth; m < LoadStep.size(); m++) LoadStep[m] = 0;
+						TempArc.Add("Trans2Energy", Load.Code + Step2Str(ctx, LoadStep), Load.Coef[Step2Pos(ctx, LoadStep) + 2]);
+					} else {
+						Step NextTempStep = NextStep(ctx, TempStep);
+						for (unsigned int m = TempArcStepCode.size(); m < Load.Depth; m++) LoadStep[m] = 1;
+						while (LoadStep < NextTempStep) {
+							TempArc.Add("Trans2Energy", Load.Code + Step2Str(ctx, LoadStep), Load.Coef[Step2Pos(ctx, LoadStep) + 2]);
+							LoadStep = NextStep(ctx, LoadStep);
+						}
+					}
+				}
+				
+				// From Investment cost, retirement cost, Fixed O&M, discount rate, lifetime  ==> Overnight cost
+				// Feature is planned but not implemented yet
+				
+				// Apply discount and inflation rate to investment and operational costs
+				double factor = (1 + TempArc.GetDouble("InflationRate")) / (1 + TempArc.GetDouble("DiscountRate"));
+				double dollar_factor = 1;
+				
+				double inv_cost = TempArc.GetDouble("InvCost");
+				double op_cost = TempArc.GetDouble("OpCost");
+				
+				if ((factor != 1) && ((inv_cost != 0) || (op_cost != 0))) {
+					for (int l = 1; l < TempStep[0]; ++l)
+						dollar_factor = dollar_factor * factor;
+				}
+				
+				// If distance is available adjust costs, emissions, demand for energy...
+				if (TempArc.Get("Distance") != "X") {
+					double distance = TempArc.GetDouble("Distance");
+					dollar_factor = dollar_factor * distance;
+					
+					for (int j = 0; j < ctx.SustMet.size(); ++j)
+						TempArc.Multiply("Op" + ctx.SustMet[j], distance);
+					TempArc.Multiply("Trans2Energy", distance);
+				}
+				
+				if (dollar_factor * ctx.OpCostScale != 1)
+					TempArc.Multiply("OpCost", dollar_factor * ctx.OpCostScale);
+				
+				// Need to adjust for investment costs at the end of the simulation period
+				string life_span = TempArc.Get("LifeSpan");
+				if (life_span != "X") {
+					int years_left = (ctx.SLength[0] + 1) - TempStep[0];
+					int life_inv = Str2Step(ctx, life_span)[0];
+					if (years_left < life_inv)  dollar_factor = dollar_factor * years_left / life_inv;
+				}
+				
+				// Store modified investment costs
+				if (dollar_factor * ctx.InvCostScale != 1)
+					TempArc.Multiply("InvCost", dollar_factor * ctx.InvCostScale);
+				
+				// Minimum flows are energy, so they scale with the periods represented
+				if (ctx.RepPeriods > 0)
+					TempArc.Multiply("OpMin", StepWeight(ctx, TempStep));
+				
+				// Store Arc for later use
+				Arcs.push_back(TempArc);
+				if (TempArc.isDCflow())
+					ListDCArcs.push_back(TempArc);
+				
+				// Store Arc indices to recover solution information
+				if (!TempArc.isTransport() || TempArc.Get("TransInfr") != "") {
+					ctx.IdxArc.Add(k, TempStep, TempArc.Get("From") + "_" + TempArc.Get("To"));
+				}
+				if (TempArc.InvArc()  && TempArc.Get("TransInfr") == "") {
+					Step YearStep(ctx.SName.size(), 0);
+					YearStep[0] = TempStep[0];
+					ctx.IdxInv.Add(k, YearStep, TempArc.Get("From") + "_" + TempArc.Get("To"));
+					if (TempArc.Get("InvMax") != "Inf")
+						ctx.IdxNsga.Add(k, YearStep, TempArc.Get("From") + "_" + TempArc.Get("To"));
+				}
+				if (TempArc.Get("OpMax") != "Inf"  && TempArc.Get("TransInfr") == "") {
+					ctx.IdxUb.Add(k, TempStep, TempArc.Get("From") + "_" + TempArc.Get("To"));
+					if (TempArc.isFirstinYear()) {
+						Step temp2(ctx.SName.size(), 0);
+						temp2[0] = TempStep[0];
+						ctx.IdxCap.Add(k, temp2, TempArc.Get("From") + "_" + TempArc.Get("To"));
+					}
+				}
+				
+				// Move to next time step
+				TempStep = NextStep(ctx, TempStep);
+				if (NextFromStep <= TempStep) {
+					TempFromStep = NextFromStep;
+					NextFromStep = NextStep(ctx, NextFromStep);
+				}
+				
+				if (isCyclic) {
+					TempToStep = CyclicStep(ctx, TempFromStep);
+				} else if (isStorage) {
+					TempToStep = NextToStep;
+					NextToStep = NextStep(ctx, NextToStep);
+					// This part of the code eliminates storage connection between different years (interferes with Benders decomposition)
+					// Must have a negative demand on the storage node for the first step in the year and a positive for the last
+					if (TempFromStep[0] != TempToStep[0]) {
+						TempStep = NextStep(ctx, TempStep);
+						TempFromStep = NextFromStep;
+						TempToStep = NextToStep;
+						NextFromStep = NextStep(ctx, NextFromStep);
+						NextToStep = NextStep(ctx, NextToStep);
+					}
+				} else if (NextToStep <= TempStep) {
+					TempToStep = NextToStep;
+					NextToStep = NextStep(ctx, NextToStep);
+				}
+			}
+		}
+	}
+	
+	// Save index for sustainability metrics
+	for (int j = 0; j < ctx.SustMet.size(); ++j)
+		for (int i = 1; i <= ctx.SLength[0]; ++i)
+			ctx.IdxEm.Add(j, i-1, i, ctx.SustMet[j]);
+	
+	
+	cout << endl << (writeFiles ? "- Writing MPS files..." : "- Building problems...") << endl;
+	int nyears = ctx.SLength[0];
+	MPSFile afile, myfile[nyears+1];
+	string Ychar = ctx.SName.substr(0,1), temp_string;
+	
+	// Short names are shared by all the files when compact names are used
+	NameDict MPSNames;
+	NameDict* names = ctx.useCompactNames ? &MPSNames : NULL;
+	
+	// The blocks store the single problem in block 0 and the Benders problems in the following ones.
+	// They are kept in memory for the solver or written as the binary model
+	vector<LPBlock> TempBlocks(0);
+	vector<LPBlock>& Blocks = (Problems != NULL) ? *Problems : TempBlocks;
+	bool useBlocks = (Problems != NULL) || (writeFiles && ctx.useBinaryModel) || ctx.useComponents;
+	Blocks.assign(useBlocks ? nyears+2 : 0, LPBlock());
+	
+	// afile stores one single MPS file (no Benders)
+	// myfile stores the Benders decomposition
+	afile.open(writeFiles ? "prepdata/netscore.mps" : NULL, names, useBlocks ? &Blocks[0] : NULL);
+	for (int i = 0; i <= nyears; ++i) {
+		string file_name = "prepdata/bend_" + ToString<int>(i) + ".mps";
+		myfile[i].open(writeFiles ? file_name.c_str() : NULL, names, useBlocks ? &Blocks[i+1] : NULL);
+	}
+	
+	// NAME and ROWS and Cost objective funtion)
+	afile << "NAME" << endl;
+	afile << "ROWS" << endl;
+	afile << " N obj" << endl;
+	for (int i = 0; i <= nyears; ++i) {
+		myfile[i] << "NAME" << endl;
+		myfile[i] << "ROWS" << endl;
+		
+		// Cost (objective funtion)
+		myfile[i] << " N obj" << endl;
+	}
+	
+	// Sustainability metrics (rows)
+	for (int j = 0; j < ctx.SustMet.size(); ++j) {
+		for (int i = 1; i <= nyears; ++i) {
+			afile << " E " << ctx.SustMet[j] << Ychar << i << endl;
+			myfile[i] << " E " << ctx.SustMet[j] << Ychar << i << endl;
+		}
+	}
+	
+	// Peak load
+	for (unsigned int i = 0; i < Nodes.size(); ++i) {
+		temp_string = Nodes[i].NodePeakRows();
+		afile << temp_string;
+		myfile[0] << temp_string;
+	}
+	
+	// Nodal demand constraints
+	for (unsigned int i = 0; i < Nodes.size(); ++i) {
+		temp_string = Nodes[i].NodeNames();
+		afile << temp_string;
+		myfile[ Nodes[i].Time() ] << temp_string;
+	}
+	
+	// Upper bound constraints rows
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].ArcUbNames();
+		afile << temp_string;
+		myfile[ Arcs[i].Time() ] << temp_string;
+	}
+	
+	// "inv2cap" constraints
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].ArcCapNames();
+		afile << temp_string;
+		myfile[0] << temp_string;
+	}
+	
+	// DC Power flow constraints
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].ArcDcNames();
+		afile << temp_string;
+		myfile[ Arcs[i].Time() ] << temp_string;
+	}
+	
+	// States of storage between the original periods (representative periods)
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].LinkNames();
+		afile << temp_string;
+		myfile[ Arcs[i].Time() ] << temp_string;
+	}
+	
+	// COLUMNS (Variables)
+	afile << "COLUMNS" << endl;
+	for (int i = 0; i <= nyears; ++i)
+		myfile[i] << "COLUMNS" << endl;
+	
+	// Cost of subproblems (BENDERS ONLY)
+	for (int i = 1; i <= nyears; ++i)
+		myfile[0] << "    cost_" << i << " obj 1" << endl;
+	
+	// Capacities  (these vary slightly for Benders)
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		afile << Arcs[i].CapArcColumns(0);
+		myfile[0] << Arcs[i].CapArcColumns(1);
+		myfile[ Arcs[i].Time() ] << Arcs[i].CapArcColumns(2);
+	}
+	
+	// Investments
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].InvArcColumns();
+		afile << temp_string;
+		myfile[0] << temp_string;
+	}
+	
+	// Sustainability metrics
+	for (int j = 0; j < ctx.SustMet.size(); ++j) {
+		for (int i = 1; i <= nyears; ++i) {
+			afile << "    " << ctx.SustMet[j] << "_" << Ychar << i << " " << ctx.SustMet[j] << Ychar << i << " -1" << endl;
+			myfile[i] << "    " << ctx.SustMet[j] << "_" << Ychar << i << " " << ctx.SustMet[j] << Ychar << i << " -1" << endl;
+		}
+	}
+	
+	// Reserve margin
+	for (unsigned int i = 0; i < Nodes.size(); ++i) {
+		temp_string = Nodes[i].NodeRMColumns();
+		afile << temp_string;
+		myfile[0] << temp_string;
+	}
+	
+	// Flows
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].ArcColumns();
+		afile << temp_string;
+		myfile[ Arcs[i].Time() ] << temp_string;
+	}
+	
+	// Unserved demands
+	for (unsigned int i = 0; i < Nodes.size(); ++i) {
+		temp_string = Nodes[i].NodeUDColumns();
+		afile << temp_string;
+		myfile[ Nodes[i].Time() ] << temp_string;
+	}
+	
+	// Power flow variables (angles)
+	vector<string> DcOutput = DCFlowColumns(ctx, ListDCNodes, ListDCArcs);
+	for (unsigned int i = 1; i < DcOutput.size(); ++i) {
+		afile << DcOutput[i];
+		myfile[i] << DcOutput[i];
+	}
+	
+	// Storage states and net changes of the representative periods
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].LinkColumns();
+		afile << temp_string;
+		myfile[ Arcs[i].Time() ] << temp_string;
+	}
+	
+	// RHS
+	afile << "RHS" << endl;
+	for (int i = 0; i <= nyears; ++i)
+		myfile[i] << "RHS" << endl;
+	
+	// Nodal Demands
+	for (unsigned int i = 0; i < Nodes.size(); ++i) {
+		temp_string = Nodes[i].NodeRhs();
+		afile << temp_string;
+		myfile[ Nodes[i].Time() ] << temp_string;
+	}
+	
+	// Initial capacity terms
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].ArcRhs();
+		afile << temp_string;
+		myfile[0] << temp_string;
+	}
+	
+	// BOUNDS
+	afile << "BOUNDS" << endl;
+	for (int i = 0; i <= nyears; ++i)
+		myfile[i] << "BOUNDS" << endl;
+	
+	// Peak load must be met
+	for (unsigned int i = 0; i < Nodes.size(); ++i) {
+		temp_string = Nodes[i].NodeRMBounds();
+		afile << temp_string;
+		myfile[0] << temp_string;
+	}
+	
+	// Flow and investment bounds
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].ArcBounds();
+		afile << temp_string;
+		myfile[ Arcs[i].Time() ] << temp_string;
+		temp_string = Arcs[i].ArcInvBounds();
+		afile << temp_string;
+		myfile[0] << temp_string;
+	}
+	
+	// DC Power flow angles
+	for (unsigned int i = 0; i < ListDCNodes.size(); ++i) {
+		temp_string = ListDCNodes[i].DCNodesBounds();
+		afile << temp_string;
+		myfile[ ListDCNodes[i].Time() ] << temp_string;
+	}
+	
+	// Net changes of storage
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		temp_string = Arcs[i].LinkBounds();
+		afile << temp_string;
+		myfile[ Arcs[i].Time() ] << temp_string;
+	}
+	
+	// Sustainability limits
+	for (int j = 0; j < ctx.SustMet.size(); ++j) {
+		int SustIndex = FindCode(ctx.SustMet[j], SustLimits);
+		if (SustIndex >= 0) {
+			Step TempStep(ctx.SName.size(), 0);
+			for (int i = 1; i <= nyears; ++i) {
+				TempStep[0] = i;
+				string Value = SustLimits[SustIndex][Step2Pos(ctx, TempStep)+1];
+				if ((Value != "X") && (ctx.LimitScale != 1))
+					Value = ToString<double>(atof(Value.c_str()) * ctx.LimitScale);
+				if (Value != "X") {
+					afile << " UP bnd " << ctx.SustMet[j] << "_" << Step2Str(ctx, TempStep) << " " << Value << endl;
+					myfile[i] << " UP bnd " << ctx.SustMet[j] << "_" << Step2Str(ctx, TempStep) << " " << Value << endl;
+				}
+			}
+		}
+	}
+	
+	// End of file
+	afile << "ENDATA";
+	afile.close();
+	for (int i = 0; i <= nyears; ++i) {
+		myfile[i] << "ENDATA";
+		myfile[i].close();
+	}
+	
+	// Dictionary to recover the original names
+	if (writeFiles && ctx.useCompactNames)
+		MPSNames.WriteFile("prepdata/names.csv");
+	
+	// Compressed version of the same problems (binary model)
+	if (useBlocks) {
+		if (writeFiles && ctx.useBinaryModel)
+			cout << "- Writing binary model..." << endl;
+		for (unsigned int i = 0; i < Blocks.size(); ++i)
+			Blocks[i].Compress();
+		
+		// Subproblems with the same structure as the first year only store their values
+		int shared = 0;
+		for (int i = 2; i <= nyears; ++i) {
+			if (Blocks[i+1].SameStructure(Blocks[2])) {
+				Blocks[i+1].UseTemplate(2);
+				++shared;
+			}
+		}
+		if (nyears > 1)
+			cout << "  Subproblems using the structure of year 1: " << shared << " / " << nyears-1 << endl;
+		
+		if (ctx.useComponents)
+			ReportComponents(ctx, Blocks, Nodes, writeFiles);
+		
+		if (writeFiles && ctx.useBinaryModel)
+			WriteModelFile("prepdata/netscore.bin", Blocks);
+	}
+	
+	
+	// *** Capacity losses for events (only the capacities that change) ***
+	Events = EventStore();
+	int cap_index = 0;
+	
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		vector<string> ArcEvents(Arcs[i].Events());
+		// If information is returned, the arc has a capacity (same order as IdxCap)
+		if (ArcEvents.size() > 0) {
+			for (int k = 1; k < ArcEvents.size(); ++k) {
+				if (ArcEvents[k] != "1")
+					Events.Add(k, cap_index, Arcs[i].Time(), atof(ArcEvents[k].c_str()));
+			}
+			++cap_index;
+		}
+	}
+	Events.Compress(ctx.Nevents);
+	
+	// Indices and events stay in memory when no files are written
+	if (!writeFiles) return;
+	
+	cout << "- Writing auxiliary files..." << endl;
+	Events.WriteFile("prepdata/events.csv");
+	
+	// *** Write node, arc information index files ***
+	WriteIndexBundle(ctx, "prepdata/indices.bin");
+	if (ctx.useTextIndices) {
+		ctx.IdxNode.WriteFile("prepdata/idx_node.csv");
+		ctx.IdxUd.WriteFile("prepdata/idx_ud.csv");
+		ctx.IdxRm.WriteFile("prepdata/idx_rm.csv");
+		ctx.IdxArc.WriteFile("prepdata/idx_arc.csv");
+		ctx.IdxInv.WriteFile("prepdata/idx_inv.csv");
+		ctx.IdxNsga.WriteFile("prepdata/idx_nsga.csv");
+		ctx.IdxCap.WriteFile("prepdata/idx_cap.csv");
+		ctx.IdxUb.WriteFile("prepdata/idx_ub.csv");
+		ctx.IdxEm.WriteFile("prepdata/idx_em.csv");
+		ctx.IdxDc.WriteFile("prepdata/idx_dc.csv");
+	}
+	
+
+	// *** Write node demand information ***
+	//WriteOutput(ctx, "prepdata/data_node_demand.csv", ctx.IdxNode, Nodes, "Demand", "% Node demand");
+	//WriteOutput(ctx, "prepdata/data_arc_opmax.csv", ctx.IdxArc, Arcs, "OpMax", "% Initial capacity");
+	//WriteOutput(ctx, "prepdata/data_arc_invcost.csv", ctx.IdxArc, Arcs, "InvCost", "% Arc: Investment costs");
+	//WriteOutput(ctx, "prepdata/data_arc_invstart.csv", ctx.IdxArc, Arcs, "InvStart", "% Arc: Investment start");
+	/*for (int j = 0; j < ctx.SustMet.size(); ++j) {
+		string file_name = "prepdata/data_arc_" + ctx.SustMet[j] + ".csv";
+		WriteOutput(ctx, file_name.c_str(), ctx.IdxArc, Arcs, "Op" + ctx.SustMet[j], "% Arc sustainability: " + ctx.SustMet[j]);
+	}*/
+	
+	
+	// *** Write multiobjective parameters file ***
+	ofstream auxfile;
+	auxfile.open("prepdata/param.in");
+
+	// Pop. size, # gen, # objectives, # constraints
+	auxfile << ctx.Npopsize << endl;
+	auxfile << ctx.Nngen << endl;
+	auxfile << ctx.Nobj << endl;
+	auxfile << "0" << endl;
+	
+	// # real variables (none use yet)
+	auxfile << "0" << endl;
+	
+	// Crossover probability, mutation, 2 more indices
+	auxfile << ctx.Npcross_real << endl;
+	auxfile << ctx.Npmut_real << endl;
+	auxfile << ctx.Neta_c << endl;
+	auxfile << ctx.Neta_m << endl;
+	
+	// Add # of binary variables, min and max for all
+	int num_var = 0;
+	string text_var = "";
+	for (unsigned int i = 0; i < Arcs.size(); ++i) {
+		if (Arcs[i].InvArc() && (Arcs[i].Get("TransInfr") == "") && (Arcs[i].Get("InvMax") != "Inf")) {
+			num_var++;
+			text_var += ctx.Nstages + " " + Arcs[i].Get("InvMin") + " " + Arcs[i].Get("InvMax") + "\n";
+		}
+	}
+	
+	auxfile << num_var << endl;
+	auxfile << text_var;
+	
+	// Crossover probability, mutation
+	auxfile << ctx.Npcross_bin << endl;
+	auxfile << ctx.Npmut_bin << endl;
+	
+	// Close file
+	auxfile.close();
+}
@@ -0,0 +1,30 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    model.h -- Definition of the model building functions
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+#ifndef _MODEL_H_
+#define _MODEL_H_
+
+#include "node.h"
+#include "arc.h"
+#include "mps.h"
+#include "event.h"
+
+// Find the row of a matrix of properties that fits best to a code, a pair of codes, a node or an arc
+int FindCode(const string& mystr, const MatrixStr mymatrix);
+int FindCode(const string& strfrom, const string& strto, const MatrixStr mymatrix);
+int FindCode(const Node& mynode, const MatrixStr mymatrix);
+int FindCode(const Arc& myarc, const MatrixStr mymatrix);
+
+// Write DC Power flow columns in the MPS file
+vector<string> DCFlowColumns(const ModelContext& ctx, const vector<Node>& v, const vector<Arc>& w);
+
+// Reads the data of a case (parameters must be read already) and builds its optimization problems.
+// The problems are stored in 'Problems' when it is not NULL (block 0 is the single problem and
+// block i+1 the Benders problem i), and the indices and events are kept in memory. The files in
+// 'prepdata' (MPS, binary model, indices, events and NSGA-II parameters) are only written if 'writeFiles'
+void BuildModel(ModelContext& ctx, vector<LPBlock>* Problems, EventStore& Events, const bool writeFiles);
+
+#endif  // _MODEL_H_
@@ -0,0 +1,402 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    mps.cpp -- Implementation of MPS and binary model functions
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+using namespace std;
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include "global.h"
+#include "mps.h"
+
+// Convert a counter into a base-36 string (0-9, a-z)
+string ToBase36(int value) {
+	const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+	string output = "";
+	do {
+		output.insert(output.begin(), digits[value % 36]);
+		value /= 36;
+	} while (value > 0);
+	return output;
+}
+
+// Split a line into the words separated by spaces
+vector<string> SplitLine(const string& line) {
+	vector<string> output(0);
+	size_t start = line.find_first_not_of(' ');
+	while (start != string::npos) {
+		size_t end = line.find(' ', start);
+		output.push_back(line.substr(start, end - start));
+		start = (end == string::npos) ? end : line.find_first_not_of(' ', end);
+	}
+	return output;
+}
+
+
+// Contructor for the NameDict class
+NameDict::NameDict() : ShortName(0), LongName(0) {}
+
+// Short code for a row. The objective function keeps its name
+string NameDict::Row(const string& name) {
+	if (name == "obj") return name;
+	return Find(Rows, name, "r");
+}
+
+// Short code for a column
+string NameDict::Column(const string& name) {
+	return Find(Columns, name, "c");
+}
+
+// Look for a name and create a new code if it hasn't been used before
+string NameDict::Find(map<string, string>& names, const string& name, const string& prefix) {
+	map<string, string>::iterator it = names.find(name);
+	if (it != names.end()) return it->second;
+	
+	string code = prefix + ToBase36(names.size());
+	names[name] = code;
+	ShortName.push_back(code);
+	LongName.push_back(name);
+	return code;
+}
+
+// Write the dictionary, one name per line
+void NameDict::WriteFile(const char* fileinput) const {
+	ofstream myfile;
+	myfile.open(fileinput);
+	myfile << "% Short name, original name" << endl;
+	for (unsigned int i = 0; i < ShortName.size(); ++i)
+		myfile << ShortName[i] << "," << LongName[i] << "\n";
+	myfile.close();
+}
+
+
+// Contructor for the LPBlock class
+LPBlock::LPBlock() :
+	sense(0), rhs(0), obj(0), lb(0), ub(0), colstart(0), rowindex(0), value(0),
+	ColRows(0), ColValues(0) { templ = -1; hasObjective = false; }
+
+// Store a line of an MPS file, already split in words
+void LPBlock::AddLine(const string& section, const vector<string>& word) {
+	if (section == "ROWS") {
+		// The first free row is the objective (-1), the rest are discarded (-2)
+		if (word.size() < 2) return;
+		if (word[0] == "N") {
+			RowIndex[word[1]] = hasObjective ? -2 : -1;
+			hasObjective = true;
+		} else {
+			RowIndex[word[1]] = sense.size();
+			sense.push_back(word[0][0]);
+			rhs.push_back(0);
+		}
+	} else if (section == "COLUMNS") {
+		if (word.size() < 3) return;
+		int col = FindColumn(word[0]);
+		for (unsigned int k = 1; k+1 < word.size(); k += 2) {
+			map<string, int>::iterator it = RowIndex.find(word[k]);
+			if (it == RowIndex.end()) continue;
+			double coef = atof(word[k+1].c_str());
+			if (it->second == -1) {
+				obj[col] += coef;
+			} else if (it->second >= 0) {
+				ColRows[col].push_back(it->second);
+				ColValues[col].push_back(coef);
+			}
+		}
+	} else if (section == "RHS") {
+		for (unsigned int k = 1; k+1 < word.size(); k += 2) {
+			map<string, int>::iterator it = RowIndex.find(word[k]);
+			if ((it != RowIndex.end()) && (it->second >= 0))
+				rhs[it->second] = atof(word[k+1].c_str());
+		}
+	} else if (section == "BOUNDS") {
+		if (word.size() < 3) return;
+		map<string, int>::iterator it = ColIndex.find(word[2]);
+		if (it == ColIndex.end()) return;
+		int col = it->second;
+		double bound = (word.size() > 3) ? atof(word[3].c_str()) : 0;
+		if (word[0] == "LO") lb[col] = bound;
+		else if (word[0] == "UP") ub[col] = bound;
+		else if (word[0] == "FX") { lb[col] = bound; ub[col] = bound; }
+		else if (word[0] == "FR") { lb[col] = -MPS_INF; ub[col] = MPS_INF; }
+		else if (word[0] == "MI") lb[col] = -MPS_INF;
+		else if (word[0] == "PL") ub[col] = MPS_INF;
+	}
+}
+
+// Find a column or create it with the default bounds
+int LPBlock::FindColumn(const string& name) {
+	map<string, int>::iterator it = ColIndex.find(name);
+	if (it != ColIndex.end()) return it->second;
+	
+	int col = obj.size();
+	ColIndex[name] = col;
+	obj.push_back(0);
+	lb.push_back(0);
+	ub.push_back(MPS_INF);
+	ColRows.push_back(vector<int>(0));
+	ColValues.push_back(vector<double>(0));
+	return col;
+}
+
+// Build the compressed sparse column matrix and release the names
+void LPBlock::Compress() {
+	colstart.assign(1, 0);
+	rowindex.clear();
+	value.clear();
+	for (unsigned int j = 0; j < ColRows.size(); ++j) {
+		rowindex.insert(rowindex.end(), ColRows[j].begin(), ColRows[j].end());
+		value.insert(value.end(), ColValues[j].begin(), ColValues[j].end());
+		colstart.push_back(rowindex.size());
+	}
+	ColRows.clear(); ColValues.clear();
+	RowIndex.clear(); ColIndex.clear();
+}
+
+// Check if two blocks have the same rows, columns and sparsity pattern
+bool LPBlock::SameStructure(const LPBlock& other) const {
+	return (sense == other.sense) && (colstart == other.colstart) && (rowindex == other.rowindex);
+}
+
+// Take the structure from another block ('index' in the model file), keeping only the values
+void LPBlock::UseTemplate(const int index) {
+	templ = index;
+	vector<char>().swap(sense);
+	vector<int>().swap(colstart);
+	vector<int>().swap(rowindex);
+}
+
+// Connected components of the matrix: rows that share a column belong to the same component, and
+// each column to the component of its rows. Empty rows and columns are assigned to component 0.
+// Components are numbered in order of their first row. Returns the number of components
+int LPBlock::Components(vector<int>& rowcomp, vector<int>& colcomp) const {
+	int nrows = sense.size(), ncols = colstart.size() - 1;
+	
+	// Union-find over the rows, with path halving
+	vector<int> parent(nrows);
+	for (int k = 0; k < nrows; ++k) parent[k] = k;
+	for (int j = 0; j < ncols; ++j) {
+		for (int n = colstart[j]+1; n < colstart[j+1]; ++n) {
+			int a = rowindex[colstart[j]], b = rowindex[n];
+			while (parent[a] != a) a = parent[a] = parent[parent[a]];
+			while (parent[b] != b) b = parent[b] = parent[parent[b]];
+			if (a != b) parent[max(a, b)] = min(a, b);
+		}
+	}
+	
+	// Roots are the first row of each component, so they are numbered before their members
+	int count = 0;
+	rowcomp.assign(nrows, 0);
+	for (int k = 0; k < nrows; ++k) {
+		int a = k;
+		while (parent[a] != a) a = parent[a];
+		rowcomp[k] = (a == k) ? count++ : rowcomp[a];
+	}
+	colcomp.assign(max(ncols, 0), 0);
+	for (int j = 0; j < ncols; ++j)
+		if (colstart[j+1] > colstart[j]) colcomp[j] = rowcomp[rowindex[colstart[j]]];
+	return max(count, 1);
+}
+
+// Write and read arrays in binary files
+template <class T>
+void WriteArray(FILE *file, const vector<T>& v) {
+	if (v.size() > 0) fwrite(&v[0], sizeof(T), v.size(), file);
+}
+
+template <class T>
+bool ReadArray(FILE *file, vector<T>& v, const int size) {
+	v.resize(size);
+	return (size == 0) || (fread(&v[0], sizeof(T), size, file) == (size_t) size);
+}
+
+// Binary model file: "NPLB", number of blocks, offset of each block and the blocks.
+// Each block stores the number of rows, columns, nonzeros and its template, followed by
+// the structure (senses and sparsity pattern) and the values (rhs, objective, bounds and matrix).
+// Blocks with a template (e.g., one year using the structure of the first year) only store values.
+void WriteModelFile(const char* fileinput, const vector<LPBlock>& blocks) {
+	FILE *file = fopen(fileinput, "wb");
+	if (file == NULL) {
+		printError("error", fileinput);
+		return;
+	}
+	
+	int nblocks = blocks.size();
+	vector<long> offset(nblocks, 0);
+	fwrite("NPLB", 1, 4, file);
+	fwrite(&nblocks, sizeof(int), 1, file);
+	long table = ftell(file);
+	fwrite(&offset[0], sizeof(long), nblocks, file);
+	
+	for (int b = 0; b < nblocks; ++b) {
+		const LPBlock& block = blocks[b];
+		int size[4] = { (int) block.rhs.size(), (int) block.obj.size(), (int) block.value.size(), block.templ };
+		offset[b] = ftell(file);
+		fwrite(size, sizeof(int), 4, file);
+		if (block.templ < 0) {
+			WriteArray(file, block.sense);
+			WriteArray(file, block.colstart);
+			WriteArray(file, block.rowindex);
+		}
+		WriteArray(file, block.rhs);
+		WriteArray(file, block.obj);
+		WriteArray(file, block.lb);
+		WriteArray(file, block.ub);
+		WriteArray(file, block.value);
+	}
+	
+	// Go back and complete the table of offsets
+	fseek(file, table, SEEK_SET);
+	fwrite(&offset[0], sizeof(long), nblocks, file);
+	fclose(file);
+}
+
+// Move to the beginning of a block and read its sizes
+bool SeekModelBlock(FILE *file, const int block, int size[]) {
+	char magic[4];
+	int nblocks = 0;
+	long offset = 0;
+	fseek(file, 0, SEEK_SET);
+	bool valid = (fread(magic, 1, 4, file) == 4) && (string(magic, 4) == "NPLB");
+	valid = valid && (fread(&nblocks, sizeof(int), 1, file) == 1) && (block >= 0) && (block < nblocks);
+	valid = valid && (fseek(file, 4 + sizeof(int) + block * sizeof(long), SEEK_SET) == 0);
+	valid = valid && (fread(&offset, sizeof(long), 1, file) == 1) && (fseek(file, offset, SEEK_SET) == 0);
+	return valid && (fread(size, sizeof(int), 4, file) == 4);
+}
+
+bool ReadModelFile(const char* fileinput, const int block, LPBlock& output) {
+	FILE *file = fopen(fileinput, "rb");
+	if (file == NULL) {
+		printError("error", fileinput);
+		return false;
+	}
+	
+	int size[4], tsize[4];
+	bool valid = SeekModelBlock(file, block, size);
+	output.templ = valid ? size[3] : -1;
+	
+	if (valid && (output.templ < 0)) {
+		valid = valid && ReadArray(file, output.sense, size[0]);
+		valid = valid && ReadArray(file, output.colstart, size[1] + 1);
+		valid = valid && ReadArray(file, output.rowindex, size[2]);
+	}
+	valid = valid && ReadArray(file, output.rhs, size[0]);
+	valid = valid && ReadArray(file, output.obj, size[1]);
+	valid = valid && ReadArray(file, output.lb, size[1]);
+	valid = valid && ReadArray(file, output.ub, size[1]);
+	valid = valid && ReadArray(file, output.value, size[2]);
+	
+	// Recover the structure from the template
+	if (valid && (output.templ >= 0)) {
+		valid = SeekModelBlock(file, output.templ, tsize) && (tsize[3] < 0);
+		valid = valid && (tsize[0] == size[0]) && (tsize[1] == size[1]) && (tsize[2] == size[2]);
+		valid = valid && ReadArray(file, output.sense, size[0]);
+		valid = valid && ReadArray(file, output.colstart, size[1] + 1);
+		valid = valid && ReadArray(file, output.rowindex, size[2]);
+	}
+	fclose(file);
+	
+	if (!valid) cout << "\tERROR: File '" << fileinput << "' is not a valid model (block " << block << ")\n";
+	return valid;
+}
+
+
+// Contructors and destructor for the MPSFile class
+MPSFile::MPSFile() : Names(NULL), Block(NULL), Section(""), Pending("") {}
+
+MPSFile::~MPSFile() {
+	close();
+}
+
+void MPSFile::open(const char* fileinput, NameDict* dict, LPBlock* block) {
+	// Without a file name, lines only go to the block
+	if (fileinput != NULL) File.open(fileinput);
+	Names = dict;
+	Block = block;
+	Section = "";
+	Pending = "";
+}
+
+void MPSFile::close() {
+	if (Pending != "") WriteLine(Pending);
+	Pending = "";
+	if (File.is_open()) File.close();
+}
+
+// Text is written directly if no dictionary or block is used. Otherwise, complete lines are processed
+MPSFile& MPSFile::operator<<(const string& text) {
+	if ((Names == NULL) && (Block == NULL)) {
+		File << text;
+	} else {
+		Pending += text;
+		size_t found = Pending.find('\n');
+		while (found != string::npos) {
+			WriteLine(Pending.substr(0, found));
+			Pending.erase(0, found + 1);
+			found = Pending.find('\n');
+		}
+	}
+	return *this;
+}
+
+MPSFile& MPSFile::operator<<(const char* text) {
+	return *this << string(text);
+}
+
+MPSFile& MPSFile::operator<<(const int value) {
+	return *this << ToString<int>(value);
+}
+
+// Only 'endl' is used, which is a new line
+MPSFile& MPSFile::operator<<(ostream& (*)(ostream&)) {
+	return *this << string("\n");
+}
+
+// Store the line and replace the names depending on the section of the MPS file
+void MPSFile::WriteLine(const string& line) {
+	if ((line.size() > 0) && (line[0] != ' ')) {
+		// Section headers start in the first column
+		Section = line;
+		File << line;
+		if (line != "ENDATA") File << "\n";
+		return;
+	}
+	
+	vector<string> word = SplitLine(line);
+	if (word.size() == 0) return;
+	
+	if (Block != NULL)
+		Block->AddLine(Section, word);
+	if (!File.is_open()) return;
+	
+	if (Names == NULL) {
+		File << line;
+	} else if ((Section == "ROWS") && (word.size() > 1)) {
+		// Row type and row name
+		File << " " << word[0] << " " << Names->Row(word[1]);
+	} else if (Section == "COLUMNS") {
+		// Column name followed by pairs of row name and value
+		File << "    " << Names->Column(word[0]);
+		for (unsigned int k = 1; k+1 < word.size(); k += 2)
+			File << " " << Names->Row(word[k]) << " " << word[k+1];
+	} else if (Section == "RHS") {
+		// RHS set name followed by pairs of row name and value
+		File << " " << word[0];
+		for (unsigned int k = 1; k+1 < word.size(); k += 2)
+			File << " " << Names->Row(word[k]) << " " << word[k+1];
+	} else if (Section == "BOUNDS") {
+		// Bound type, bound set name, column name and value
+		if (word.size() > 2) word[2] = Names->Column(word[2]);
+		File << " " << word[0];
+		for (unsigned int k = 1; k < word.size(); ++k)
+			File << " " << word[k];
+	} else {
+		File << line;
+	}
+	File << "\n";
+}
@@ -0,0 +1,94 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    mps.h -- Definition of MPS and binary model functions
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+#ifndef _MPS_H_
+#define _MPS_H_
+
+#include <map>
+
+// Bounds above this value are considered infinite (same as Cplex)
+#define MPS_INF 1.0e20
+
+// Declare class to translate row and column names into short base-36 codes
+class NameDict {
+	public:
+		NameDict();
+		
+		string Row(const string& name);
+		string Column(const string& name);
+		void WriteFile(const char* fileinput) const;
+		
+	private:
+		string Find(map<string, string>& names, const string& name, const string& prefix);
+		
+		map<string, string> Rows, Columns;
+		vector<string> ShortName, LongName;
+};
+
+// Declare class to store one optimization block (the content of one MPS file) in memory.
+// Rows are kept in the same order as in the MPS file, without the objective and other free rows,
+// and columns in order of appearance, which is the same order that Cplex uses when importing.
+class LPBlock {
+	public:
+		LPBlock();
+		
+		void AddLine(const string& section, const vector<string>& word);
+		void Compress();
+		bool SameStructure(const LPBlock& other) const;
+		void UseTemplate(const int index);
+		int Components(vector<int>& rowcomp, vector<int>& colcomp) const;
+		
+		// Rows: sense ('E', 'L' or 'G') and right hand side
+		vector<char> sense;
+		vector<double> rhs;
+		
+		// Columns: objective coefficient, bounds and matrix in compressed sparse column format
+		vector<double> obj, lb, ub;
+		vector<int> colstart, rowindex;
+		vector<double> value;
+		
+		// Block that provides the structure (-1 if the block has its own)
+		int templ;
+		
+	private:
+		int FindColumn(const string& name);
+		
+		map<string, int> RowIndex, ColIndex;
+		vector< vector<int> > ColRows;
+		vector< vector<double> > ColValues;
+		bool hasObjective;
+};
+
+// Write several blocks in one binary file, and read one of them back
+void WriteModelFile(const char* fileinput, const vector<LPBlock>& blocks);
+bool ReadModelFile(const char* fileinput, const int block, LPBlock& output);
+
+// Declare class to write MPS files. Lines are passed through untouched, unless
+// a dictionary is provided, in which case the names are replaced by short codes.
+// If a block is provided, the lines are also stored in it.
+class MPSFile {
+	public:
+		MPSFile();
+		~MPSFile();
+		
+		void open(const char* fileinput, NameDict* dict = NULL, LPBlock* block = NULL);
+		void close();
+		
+		MPSFile& operator<<(const string& text);
+		MPSFile& operator<<(const char* text);
+		MPSFile& operator<<(const int value);
+		MPSFile& operator<<(ostream& (*manip)(ostream&));
+		
+	private:
+		void WriteLine(const string& line);
+		
+		ofstream File;
+		NameDict* Names;
+		LPBlock* Block;
+		string Section, Pending;
+};
+
+#endif  // _MPS_H_
@@ -14,21 +14,22 @@ using namespace std;
 #include "node.h"
 
 // Contructors and destructor for the Node class
-Node::Node() : Properties(NodeDefault) {}
+Node::Node(const ModelContext& ctx) : Properties(ctx.NodeDefault), Context(&ctx) {}
 
-Node::Node(const Node& rhs) : Properties(rhs.GetVecStr()) {}
+Node::Node(const Node& rhs) : Properties(rhs.GetVecStr()), Context(rhs.Context) {}
 
 Node::~Node() {}
 
 Node& Node::operator=(const Node& rhs) {
 	Properties = rhs.GetVecStr();
+	Context = rhs.Context;
 	return *this;
 }
 
 // Read a node property in string format
 string Node::Get(const string& selector) const {
 	string temp_output;
-	int index = FindNodeSelector(selector);
+	int index = FindNodeSelector(*Context, selector);
 	if (index >= 0) temp_output = Properties[index];
 	else {
 		temp_output = "ERROR";
@@ -51,14 +52,14 @@ vector<string> Node::GetVecStr() const {
 
 // Modify a property
 void Node::Set(const string& selector, const string& input){
-	int index = FindNodeSelector(selector);
+	int index = FindNodeSelector(*Context, selector);
 	if (index >= 0) Properties[index] = input;
 	else printError("nodewrite", selector);
 };
 
 // Multiply stored values by 'value'
 void Node::Multiply(const string& selector, const double value) {
-	int index = FindNodeSelector(selector);
+	int index = FindNodeSelector(*Context, selector);
 	if (index >= 0) {
 		double actual = GetDouble(selector);
 		if (actual != 0) {
@@ -69,7 +70,7 @@ void Node::Multiply(const string& selector, const double value) {
 
 // Get what time the node belongs to (i.e., year)
 int Node::Time() const {
-	return Str2Step(Get("Step"))[0];
+	return Str2Step(*Context, Get("Step"))[0];
 }
 
 
@@ -142,14 +143,14 @@ string Node::DCNodesBounds() const {
 // ****** Boolean functions ******
 // Is Node a DC node and are we considering DC flow in the model?
 bool Node::isDCflow() const {
-	return (Get("ShortCode").substr(0,2) == DCCode) && useDCflow;
+	return (Get("ShortCode").substr(0,2) == Context->DCCode) && Context->useDCflow;
 }
 
 // Is this the first node in a year?
 bool Node::isFirstinYear() const {
 	bool output = true;
-	Step tempstep = Str2Step(Get("Step"));
-	for (unsigned int k = 1; k < SName.size(); k++)
+	Step tempstep = Str2Step(*Context, Get("Step"));
+	for (unsigned int k = 1; k < Context->SName.size(); k++)
 		output = output && ((tempstep[k]==0) || (tempstep[k]==1));
 	
 	return output;
@@ -157,10 +158,10 @@ bool Node::isFirstinYear() const {
 
 // ****** Other functions ******
 // Find the index for a node property selector
-int FindNodeSelector(const string& selector) {
+int FindNodeSelector(const ModelContext& ctx, const string& selector) {
 	int index = -1;
-	for (unsigned int k = 0; k < NodeProp.size(); ++k) {
-		if (selector == NodeProp[k]) index = k;
+	for (unsigned int k = 0; k < ctx.NodeProp.size(); ++k) {
+		if (selector == ctx.NodeProp[k]) index = k;
 	}
 	return index;
 }
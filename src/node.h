@@ -10,7 +10,7 @@
 // Declare class type to hold node information
 class Node {
 	public:
-		Node();
+		Node(const ModelContext& ctx);
 		Node(const Node& rhs);
 		~Node();
 		Node& operator=(const Node& rhs);
@@ -35,9 +35,10 @@ class Node {
 		
 	private:
 		vector<string> Properties;
+		const ModelContext* Context;
 };
 
 // Find the index for a node property selector
-int FindNodeSelector(const string& selector);
+int FindNodeSelector(const ModelContext& ctx, const string& selector);
 
 #endif  // _NODE_H_
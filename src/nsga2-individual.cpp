@@ -1,6 +1,6 @@
 // --------------------------------------------------------------
 //    NETSCORE Version 2
-//    nsga2-individual.cpp - Evaluation of an individual
+//    nsga2-individual.cpp - Evaluation of individuals sent by another process
 //    2009-2011 (c) Eduardo Ibanez
 // --------------------------------------------------------------
 
@@ -9,40 +9,42 @@ using namespace std;
 #include <fstream>
 #include <string>
 #include <vector>
+#include <cstdlib>
 #include "netscore.h"
 #include "solver.h"
+#include "farm.h"
+
+// The individuals are read from the file descriptor in the first argument (standard input by default)
+// and the objectives are written to the second one (standard output). The messages use the same format
+// as the evaluation processes of nsga2p, so this program can serve a coordinator through a pipe
+int main (int argc, char **argv) {
+	int in = (argc > 1) ? atoi(argv[1]) : 0, out = (argc > 2) ? atoi(argv[2]) : 1;
+
+	// Messages on screen must not be mixed with the objectives
+	if (out == 1)
+		cout.rdbuf(cerr.rdbuf());
+
+	printHeader("nsga-parallel");
 
-int main () {
-	printHeader("postprocessor");
-	
 	// Read global parameters
-	ReadParameters("data/parameters.csv");
-	
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
+
 	// Import indices to export data
-	ImportIndices();
-	
+	ImportIndices(ctx);
+
 	// Declare variables to store the optimization model
-	CPLEX netplan;
-	
+	CPLEX netplan(ctx);
+
 	// Read master and subproblems
 	netplan.LoadProblem();
-	
-	// Vector of capacity losses for events
-	double events[(SLength[0] + IdxCap.GetSize()) * (Nevents+1)];
-	ReadEvents(events, "prepdata/bend_events.csv");
-	
-	// JINXU: BEGIN LOOP WHILE THERE ARE INSTANCES TO BE SOLVED
-		
-		// JINXU: GET variables FROM CENTRAL NODE
-		
-		// Solve problem
-		double variables[IdxInv.GetSize()];
-		double objective[Nobj];
-		netplan.SolveProblem(variables, objective, events);
-		
-		// JINXU: TRANSFER  objective TO CENTRAL NODE
-		
-	// JINXU: CLOSE LOOP
-	
+
+	// Capacity losses for events
+	EventStore events = ReadEventStore(ctx, "prepdata/events.csv");
+
+	// Solve the individuals until the other end is closed
+	EvalFarm::Serve(netplan, events, in, out);
+
+	printHeader("completed");
 	return 0;
 }
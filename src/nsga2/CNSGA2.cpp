@@ -1,11 +1,57 @@
 #include "../solver.h"
 #include "CNSGA2.h"
+#include <pthread.h>
+#include <algorithm>
+
+// Population evaluated by several threads. Each thread takes the next individual of 'order'
+// (atomic counter, no lock) and solves it with its own solver
+struct PopulationWork {
+	population* pop;
+	const vector<int>* order;
+	const EventStore* events;
+	vector<char>* solve;
+	vector<char>* pruned;
+	vector<string>* metrics;
+	int next;
+};
+
+struct PopulationThread {
+	PopulationWork* work;
+	CPLEX* solver;
+	bool load;
+	long iterations;
+};
+
+void* PopulationWorker(void* arg) {
+	PopulationThread* thread = (PopulationThread*) arg;
+	PopulationWork* work = thread->work;
+	CPLEX& solver = *thread->solver;
+	if (thread->load)
+		solver.LoadProblem();
+	
+	solver.Iterations();
+	for (;;) {
+		int n = __sync_fetch_and_add(&work->next, 1);
+		if (n >= (int) work->order->size())
+			break;
+		int i = (*work->order)[n];
+		if (!(*work->solve)[i])
+			continue;
+		cout << "\tIndividual: " + ToString<int>(i+1) + "\n" << flush;
+		solver.SolveProblem((&work->pop->ind[i])->xbin, (&work->pop->ind[i])->obj, *work->events, &(*work->metrics)[i]);
+		(*work->pruned)[i] = solver.Pruned;
+	}
+	thread->iterations = solver.Iterations();
+	return NULL;
+}
 
 CNSGA2::CNSGA2(bool output, double seed) {
 	randgen = new CRand(seed);
-	if (output) fileio = new CFileIO(this);
+	fileio = output ? new CFileIO(this) : NULL;
 	quicksort = new CQuicksort(randgen);
 	linkedlist = new CLinkedList();
+	cacheClock = 0;
+	farm = NULL;
 }
 
 CNSGA2::~CNSGA2(void) {
@@ -24,6 +70,9 @@ CNSGA2::~CNSGA2(void) {
 		free (nbits);
 	}
 	
+	for (unsigned int t = 0; t < threadSolvers.size(); t++)
+		delete threadSolvers[t];
+	
 	deallocate_memory_pop (parent_pop, popsize);
 	deallocate_memory_pop (child_pop, popsize);
 	deallocate_memory_pop (mixed_pop, 2*popsize);
@@ -230,7 +279,7 @@ void CNSGA2::ResumePop(population *pop, const char* fileinput) {
 			}
 			
 			// Skip objectives
-			for (int j=1; j < Nobj; ++j) {
+			for (int j=1; j < nobj; ++j) {
 				fscanf (file, "%s", tmp);
 			}
 			
@@ -279,35 +328,485 @@ void CNSGA2::decodeInd(individual *ind) {
 }
 
 /* Routine to evaluate objective function values and constraints for a population */
-void CNSGA2::evaluatePop(population *pop, CPLEX& netplan, const double events[]) {
+void CNSGA2::evaluatePop(population *pop, CPLEX& netplan, const EventStore& events) {
+	// Order of evaluation: as in the population, or similar individuals one after the other
+	// so that each solution starts from the basis of a similar one
+	vector<int> order(popsize);
+	for (int i=0; i<popsize; i++)
+		order[i] = i;
+	if (netplan.ctx.NevalOrder == "similarity")
+		order = similarityOrder(pop);
+	
+	// Individuals evaluated before (in this run or a previous one) are not solved again
+	bool useCache = netplan.ctx.NevalCache;
+	if (useCache && !evalCache.IsOpen())
+		evalCache.Open("nsgadata/eval_cache.csv", nbin, nobj);
+	
+	// Individuals dominated by the front of the parents are not solved completely
+	netplan.PruneFront.clear();
+	if (netplan.ctx.Nprune && (pop != parent_pop)) {
+		for (int i=0; i<popsize; i++)
+			if ((&parent_pop->ind[i])->rank == 1)
+				netplan.PruneFront.push_back(vector<double>((&parent_pop->ind[i])->obj, (&parent_pop->ind[i])->obj + nobj));
+	}
+	int pruned = 0;
+	long iterations = 0;
+	
+	// Several threads, each one with its own solver (the bases are not cached)
+	if (netplan.ctx.Nthreads > 1) {
+		pruned = evaluateParallel(pop, netplan, events, order, iterations);
+	} else {
+		netplan.Iterations();
+		for (int n=0; n<popsize; n++) {
+			int i = order[n];
+			(&pop->ind[i])->constr_violation = 0.0;
+			if (useCache && evalCache.Find((&pop->ind[i])->xbin, (&pop->ind[i])->obj)) {
+				cout << "\tIndividual: " << i+1 << " (cached)" << endl;
+				continue;
+			}
+			cout << "\tIndividual: " << i+1 << endl;
+			vector<int> genes = genotype(&pop->ind[i]);
+			
+			// Start from the basis of the closest individual in the cache, if it is closer than the last one
+			int cached = nearestBasis(genes);
+			if ((cached >= 0) && (lastGenes.empty() || (hamming(genes, cacheGenes[cached]) < hamming(genes, lastGenes)))) {
+				netplan.SetBasis(cacheBasis[cached]);
+				cacheUse[cached] = ++cacheClock;
+			}
+			
+			string metrics = "";
+			netplan.SolveProblem((&pop->ind[i])->xbin, (&pop->ind[i])->obj, events, &metrics);
+			//evaluateInd (&(pop->ind[i]), events, netplan);
+			if (netplan.Pruned) {
+				// Its objectives are only bounds, so it is ranked behind every evaluated individual
+				(&pop->ind[i])->constr_violation = -1.0;
+				++pruned;
+			} else if (useCache)
+				evalCache.Add((&pop->ind[i])->xbin, (&pop->ind[i])->obj, &metrics);
+			
+			storeBasis(genes, netplan);
+			lastGenes = genes;
+		}
+		iterations = netplan.Iterations();
+	}
+	cout << "\tSimplex iterations per individual: " << iterations / popsize << endl;
+	if (!netplan.PruneFront.empty())
+		cout << "\tDominated individuals stopped: " << pruned << endl;
+	netplan.PruneFront.clear();
+	
+	if (useCache) {
+		cout << "\tEvaluation cache: " << evalCache.hits << " hits, " << evalCache.misses << " misses" << endl;
+		evalCache.hits = 0;
+		evalCache.misses = 0;
+		evalCache.Flush();
+	}
+}
+
+/* Evaluates the individuals with several threads (threads), the first one with 'netplan' and the others
+   with their own solvers, loaded the first time. Returns the number of individuals stopped by the front */
+int CNSGA2::evaluateParallel(population *pop, CPLEX& netplan, const EventStore& events, const vector<int>& order, long& iterations) {
+	int nthreads = min(netplan.ctx.Nthreads, popsize);
+	bool useCache = netplan.ctx.NevalCache;
+	
+	// Individuals in the cache are not solved
+	vector<char> solve(popsize, 1), pruned(popsize, 0);
+	vector<string> metrics(popsize);
 	for (int i=0; i<popsize; i++) {
-		cout << "\tIndividual: " << i+1 << endl;
-		netplan.SolveProblem((&pop->ind[i])->xbin, (&pop->ind[i])->obj, events);
 		(&pop->ind[i])->constr_violation = 0.0;
-		//evaluateInd (&(pop->ind[i]), events, netplan);
+		if (useCache && evalCache.Find((&pop->ind[i])->xbin, (&pop->ind[i])->obj)) {
+			cout << "\tIndividual: " << i+1 << " (cached)" << endl;
+			solve[i] = 0;
+		}
 	}
+	
+	vector<PopulationThread> threads(nthreads);
+	PopulationWork work;
+	work.pop = pop; work.order = &order; work.events = &events; work.solve = &solve; work.pruned = &pruned; work.metrics = &metrics; work.next = 0;
+	for (int t = 0; t < nthreads; t++) {
+		threads[t].work = &work;
+		threads[t].load = false;
+		threads[t].iterations = 0;
+		if (t == 0) {
+			threads[t].solver = &netplan;
+		} else {
+			if (threadSolvers.size() < t) {
+				threadSolvers.push_back(new CPLEX(netplan.ctx));
+				threads[t].load = true;
+			}
+			threads[t].solver = threadSolvers[t-1];
+			threads[t].solver->PruneFront = netplan.PruneFront;
+		}
+	}
+	
+	vector<pthread_t> ids(nthreads);
+	for (int t = 0; t < nthreads; t++)
+		pthread_create(&ids[t], NULL, PopulationWorker, &threads[t]);
+	for (int t = 0; t < nthreads; t++) {
+		pthread_join(ids[t], NULL);
+		iterations += threads[t].iterations;
+		if (t > 0)
+			threads[t].solver->PruneFront.clear();
+	}
+	
+	int stopped = 0;
+	for (int i=0; i<popsize; i++) {
+		if (pruned[i]) {
+			(&pop->ind[i])->constr_violation = -1.0;
+			++stopped;
+		} else if (useCache && solve[i])
+			evalCache.Add((&pop->ind[i])->xbin, (&pop->ind[i])->obj, &metrics[i]);
+	}
+	return stopped;
 }
 
-/* Routine to evaluate objective function values and constraints for a population */
+/* Bits of the binary variables of an individual */
+vector<int> CNSGA2::genotype(individual *ind) {
+	vector<int> genes;
+	for (int j = 0; j < nbin; j++)
+		for (int k = 0; k < nbits[j]; k++)
+			genes.push_back(ind->gene[j][k]);
+	return genes;
+}
+
+/* Number of bits that differ between two genotypes */
+int CNSGA2::hamming(const vector<int>& a, const vector<int>& b) {
+	int dist = 0;
+	for (unsigned int k = 0; k < a.size() && k < b.size(); k++)
+		if (a[k] != b[k]) ++dist;
+	return dist;
+}
+
+/* Greedy nearest neighbour tour of the population under Hamming distance, starting
+   from the individual closest to the last one evaluated */
+vector<int> CNSGA2::similarityOrder(population *pop) {
+	vector< vector<int> > genes(popsize);
+	for (int i=0; i<popsize; i++)
+		genes[i] = genotype(&pop->ind[i]);
+	
+	vector<int> order;
+	vector<bool> visited(popsize, false);
+	const vector<int>* last = lastGenes.empty() ? &genes[0] : &lastGenes;
+	for (int n=0; n<popsize; n++) {
+		int best = -1, bestDist = 0;
+		for (int i=0; i<popsize; i++) {
+			if (visited[i]) continue;
+			int dist = hamming(*last, genes[i]);
+			if ((best < 0) || (dist < bestDist)) {
+				best = i;
+				bestDist = dist;
+			}
+		}
+		visited[best] = true;
+		order.push_back(best);
+		last = &genes[best];
+	}
+	return order;
+}
+
+/* Position of the cached basis with the closest genotype (-1 if the cache is empty) */
+int CNSGA2::nearestBasis(const vector<int>& genes) {
+	int best = -1, bestDist = 0;
+	for (unsigned int c = 0; c < cacheGenes.size(); c++) {
+		int dist = hamming(genes, cacheGenes[c]);
+		if ((best < 0) || (dist < bestDist)) {
+			best = c;
+			bestDist = dist;
+		}
+	}
+	return best;
+}
+
+/* Keeps the basis of the base case of an individual in the cache (basiscache entries). A genotype
+   that is already in the cache replaces its basis; otherwise the least recently used entry is replaced.
+   Individuals stopped before the base case was solved have no basis to keep */
+void CNSGA2::storeBasis(const vector<int>& genes, CPLEX& netplan) {
+	int size = netplan.ctx.NbasisCache;
+	if ((size <= 0) || netplan.BaseBasis.cols.empty())
+		return;
+	
+	int c = nearestBasis(genes);
+	if ((c < 0) || (hamming(genes, cacheGenes[c]) > 0)) {
+		if (cacheGenes.size() < size) {
+			c = cacheGenes.size();
+			cacheGenes.push_back(genes);
+			cacheBasis.push_back(Basis());
+			cacheUse.push_back(0);
+		} else {
+			c = 0;
+			for (unsigned int k = 1; k < cacheUse.size(); k++)
+				if (cacheUse[k] < cacheUse[c]) c = k;
+			cacheGenes[c] = genes;
+		}
+	}
+	cacheBasis[c] = netplan.BaseBasis;
+	cacheUse[c] = ++cacheClock;
+}
+
+/* Routine to send a population to the evaluation processes (it returns without waiting) */
 void CNSGA2::sendPop(population *pop) {
+	// Individuals evaluated before are not sent
+	bool useCache = farm->ctx.NevalCache;
+	if (useCache && !evalCache.IsOpen())
+		evalCache.Open("nsgadata/eval_cache.csv", nbin, nobj);
+	
+	vector<double*> x, obj;
+	vector<string*> text;
+	vector<int>& sent = farmSent[pop];
+	vector<string>& metrics = farmMetrics[pop];
+	sent.clear();
+	metrics.assign(popsize, "");
 	for (int i=0; i<popsize; i++) {
-		// Send to queue:		(&pop->ind[i])->xbin,
-		// (&pop->ind[i])->obj, events);						// JINXU: Connect this line to nsga2-individual.cpp
 		(&pop->ind[i])->constr_violation = 0.0;
-		//evaluateInd (&(pop->ind[i]), events, netplan);
+		if (useCache && evalCache.Find((&pop->ind[i])->xbin, (&pop->ind[i])->obj))
+			continue;
+		x.push_back((&pop->ind[i])->xbin);
+		obj.push_back((&pop->ind[i])->obj);
+		text.push_back(&metrics[i]);
+		sent.push_back(i);
 	}
+	farmBatch[pop] = farm->Submit(x, obj, text);
 }
 
-/* Routine to evaluate objective function values and constraints for a population */
+/* Routine to wait for the objective function values of a population sent before */
 void CNSGA2::receivePop(population *pop) {
-	for (int i=0; i<popsize; i++) {
-		// Receive from workers:  (&pop->ind[i])->obj			// JINXU: Connect this line to nsga2-individual.cpp
-		(&pop->ind[i])->constr_violation = 0.0;
+	int batch = farmBatch[pop];
+	farm->Wait(batch);
+	farmBatch.erase(pop);
+	
+	if (farm->ctx.NevalCache) {
+		// Only the individuals evaluated now (the others were found in the cache or lost their workers)
+		const vector<int>& sent = farmSent[pop];
+		for (unsigned int k=0; k < sent.size(); k++)
+			if (farm->Returned(batch, k))
+				evalCache.Add((&pop->ind[sent[k]])->xbin, (&pop->ind[sent[k]])->obj, &farmMetrics[pop][sent[k]]);
+		cout << "\tEvaluation cache: " << evalCache.hits << " hits, " << evalCache.misses << " misses" << endl;
+		evalCache.hits = 0;
+		evalCache.misses = 0;
+		evalCache.Flush();
+	}
+	farmSent.erase(pop);
+	farmMetrics.erase(pop);
+	farm->Report();
+}
+
+/* Asynchronous steady-state NSGA-II: the workers of the farm always have a child to evaluate, and each
+   child is inserted in the parent population as soon as it returns. Every popsize evaluations are
+   reported as a generation */
+void CNSGA2::evolveAsync(const int children) {
+	bool useCache = farm->ctx.NevalCache;
+	int slots = min(farm->Size(), popsize);
+	int created = 0, finished = 0, accepted = 0;
+	
+	// Children being evaluated (group of the farm and position in child_pop) and their metrics
+	map<int, int> running;
+	vector<string> metrics(slots);
+	vector<int> idle;
+	for (int s = slots-1; s >= 0; s--)
+		idle.push_back(s);
+	
+	while (finished < children) {
+		int s = -1;
+		if (!idle.empty() && (created < children)) {
+			// New child in an idle position, only sent if it is not in the cache
+			s = idle.back();
+			idle.pop_back();
+			makeChild(&child_pop->ind[s]);
+			++created;
+			if (!useCache || !evalCache.Find((&child_pop->ind[s])->xbin, (&child_pop->ind[s])->obj)) {
+				running[farm->Submit(vector<double*>(1, (&child_pop->ind[s])->xbin), vector<double*>(1, (&child_pop->ind[s])->obj), vector<string*>(1, &metrics[s]))] = s;
+				continue;
+			}
+		} else {
+			// Wait for the next child
+			int batch = farm->WaitAny();
+			s = running[batch];
+			running.erase(batch);
+			if (useCache && farm->Returned(batch, 0))
+				evalCache.Add((&child_pop->ind[s])->xbin, (&child_pop->ind[s])->obj, &metrics[s]);
+		}
+		
+		if (insertInd(parent_pop, &child_pop->ind[s]))
+			++accepted;
+		idle.push_back(s);
+		++finished;
+		
+		if ((finished % popsize == 0) || (finished == children)) {
+			int gen = 1 + (finished + popsize - 1) / popsize;
+			fprintf(fileio->fpt4,"# gen = %d\n", gen);
+			fileio->report_pop(parent_pop, fileio->fpt4);
+			fileio->flushIO();
+			cout << "- Finished generation #" << gen << " (" << accepted << " children accepted)" << endl;
+			farm->Report();
+			if (useCache) {
+				cout << "\tEvaluation cache: " << evalCache.hits << " hits, " << evalCache.misses << " misses" << endl;
+				evalCache.hits = 0;
+				evalCache.misses = 0;
+				evalCache.Flush();
+			}
+			accepted = 0;
+		}
+	}
+}
+
+/* Creates a child by crossover of two parents selected by tournament, and mutation */
+void CNSGA2::makeChild(individual *child) {
+	individual *parent1, *parent2;
+	int a = randgen->rnd(0, popsize-1), b = randgen->rnd(0, popsize-1);
+	int c = randgen->rnd(0, popsize-1), d = randgen->rnd(0, popsize-1);
+	parent1 = tournament(&parent_pop->ind[a], &parent_pop->ind[b]);
+	parent2 = tournament(&parent_pop->ind[c], &parent_pop->ind[d]);
+	
+	// The second child of the crossover is not used
+	crossover(parent1, parent2, child, &mixed_pop->ind[2*popsize-1]);
+	mutateInd(child);
+	decodeInd(child);
+	child->constr_violation = 0.0;
+}
+
+/* Inserts an evaluated individual in a population whose ranks and crowding distances are known.
+   The fronts better than the one of the new individual do not change, so only the individuals of
+   that front and the worse ones are sorted again. The individual of the last front with the
+   smallest crowding distance is removed (it may be the new one). Returns true if it enters */
+bool CNSGA2::insertInd(population *pop, individual *ind) {
+	vector<individual*> all(popsize + 1);
+	for (int i=0; i<popsize; i++)
+		all[i] = &pop->ind[i];
+	all[popsize] = ind;
+	
+	// Front of the new individual: the first one where no individual dominates it
+	int rank = 1;
+	for (bool found = false; !found; ) {
+		bool exists = false, dominated = false;
+		for (int i=0; i<popsize && !dominated; i++) {
+			if (all[i]->rank != rank) continue;
+			exists = true;
+			if (checkDominance(all[i], ind) == 1) dominated = true;
+		}
+		if (!exists || !dominated) found = true;
+		else ++rank;
+	}
+	
+	// Sort the individuals of that front and the worse ones
+	vector<int> rest;
+	vector< vector<int> > fronts;
+	for (int i=0; i<=popsize; i++)
+		if ((i == popsize) || (all[i]->rank >= rank)) rest.push_back(i);
+	while (!rest.empty()) {
+		vector<int> front, next;
+		for (unsigned int a=0; a < rest.size(); a++) {
+			bool dominated = false;
+			for (unsigned int b=0; b < rest.size() && !dominated; b++)
+				if (checkDominance(all[rest[b]], all[rest[a]]) == 1) dominated = true;
+			if (dominated) next.push_back(rest[a]);
+			else front.push_back(rest[a]);
+		}
+		for (unsigned int a=0; a < front.size(); a++)
+			all[front[a]]->rank = rank + fronts.size();
+		fronts.push_back(front);
+		rest.swap(next);
+	}
+	
+	// Remove the most crowded individual of the last front
+	vector<individual*> last;
+	for (unsigned int a=0; a < fronts.back().size(); a++)
+		last.push_back(all[fronts.back()[a]]);
+	assignCrowdingDistanceVector(last);
+	int worst = 0;
+	for (unsigned int a=1; a < last.size(); a++)
+		if (last[a]->crowd_dist < last[worst]->crowd_dist) worst = a;
+	worst = fronts.back()[worst];
+	if (worst == popsize) {
+		// The population has the same ranks as before, only the crowding of the last front changed
+		vector<individual*> front;
+		for (unsigned int a=0; a < fronts.back().size(); a++)
+			if (fronts.back()[a] != popsize) front.push_back(all[fronts.back()[a]]);
+		assignCrowdingDistanceVector(front);
+		return false;
+	}
+	
+	// The new individual takes the place of the removed one, crowding distances of the fronts that changed
+	copyInd(ind, all[worst]);
+	for (unsigned int f=0; f < fronts.size(); f++) {
+		vector<individual*> front;
+		for (unsigned int a=0; a < fronts[f].size(); a++) {
+			int i = fronts[f][a];
+			if (i == popsize) front.push_back(all[worst]);
+			else if (i != worst) front.push_back(all[i]);
+		}
+		if (!front.empty())
+			assignCrowdingDistanceVector(front);
+	}
+	return true;
+}
+
+/* Copies the migrants of the parent population to 'out'. With "best", the individuals of the first
+   fronts with the largest crowding distance; with "random", any individuals (partial shuffle) */
+void CNSGA2::emigrate(population *out, const int count, const string& select) {
+	vector< pair< pair<int, double>, int> > order;
+	for (int i=0; i<popsize; i++)
+		order.push_back(make_pair(make_pair((&parent_pop->ind[i])->rank, -(&parent_pop->ind[i])->crowd_dist), i));
+	if (select == "random") {
+		for (int i=0; i<count; i++)
+			swap(order[i], order[randgen->rnd(i, popsize-1)]);
+	} else {
+		sort(order.begin(), order.end());
+	}
+	for (int i=0; i<count; i++)
+		copyInd(&parent_pop->ind[order[i].second], &out->ind[i]);
+}
+
+/* Inserts the migrants received in 'in' in the parent population, which must have its ranks and
+   crowding distances. Migrants already in the population are skipped. Returns the number accepted */
+int CNSGA2::immigrate(population *in, const int count) {
+	int accepted = 0;
+	for (int m=0; m<count; m++) {
+		individual *ind = &in->ind[m];
+		bool repeated = false;
+		for (int i=0; i<popsize && !repeated; i++) {
+			repeated = true;
+			for (int j=0; j<nbin && repeated; j++)
+				if ((&parent_pop->ind[i])->xbin[j] != ind->xbin[j]) repeated = false;
+		}
+		if (!repeated && insertInd(parent_pop, ind))
+			++accepted;
+	}
+	return accepted;
+}
+
+/* Crowding distances of the individuals of a front, computed as in assignCrowdingDistance */
+void CNSGA2::assignCrowdingDistanceVector(vector<individual*>& front) {
+	int size = front.size();
+	if (size <= 2) {
+		for (int j=0; j<size; j++)
+			front[j]->crowd_dist = INF;
+		return;
+	}
+	
+	for (int j=0; j<size; j++)
+		front[j]->crowd_dist = 0.0;
+	vector< vector< pair<double, int> > > sorted(nobj);
+	for (int i=0; i<nobj; i++) {
+		for (int j=0; j<size; j++)
+			sorted[i].push_back(make_pair(front[j]->obj[i], j));
+		sort(sorted[i].begin(), sorted[i].end());
+		front[sorted[i][0].second]->crowd_dist = INF;
+	}
+	
+	for (int i=0; i<nobj; i++) {
+		double range = sorted[i][size-1].first - sorted[i][0].first;
+		for (int j=1; j<size-1; j++) {
+			individual* ind = front[sorted[i][j].second];
+			if ((ind->crowd_dist != INF) && (range > 0))
+				ind->crowd_dist += (sorted[i][j+1].first - sorted[i][j-1].first) / range;
+		}
 	}
+	for (int j=0; j<size; j++)
+		if (front[j]->crowd_dist != INF)
+			front[j]->crowd_dist /= nobj;
 }
 
 /* Routine to evaluate objective function values and constraints for an individual */
-/*void CNSGA2::evaluateInd(individual *ind, const double events[], CPLEX& netplan) {
+/*void CNSGA2::evaluateInd(individual *ind, const EventStore& events, CPLEX& netplan) {
 	netplan.SolveProblem(ind->xbin, ind->obj, events);
 	// test_problem (ind->xreal, ind->xbin, ind->gene, ind->obj, ind->constr);
 	if (ncon==0)
@@ -12,6 +12,9 @@
 #include "CLinkedList.h"
 #include "defines.h"
 #include "../solver.h"
+#include "../evalcache.h"
+#include "../farm.h"
+#include <map>
 
 using namespace std;
 
@@ -46,10 +49,18 @@ class CNSGA2 {
 		void decodeInd(individual *ind);
 		
 		// Population evaluate methods
-		void evaluatePop(population *pop, CPLEX& netplan, const double events[]);
+		void evaluatePop(population *pop, CPLEX& netplan, const EventStore& events);
+		int evaluateParallel(population *pop, CPLEX& netplan, const EventStore& events, const vector<int>& order, long& iterations);
 		void sendPop(population *pop);
 		void receivePop(population *pop);
-		// void evaluateInd(individual *ind, const double events[], CPLEX& netplan);
+		// void evaluateInd(individual *ind, const EventStore& events, CPLEX& netplan);
+		
+		// Evaluation order by similarity of the genotypes and cache of bases (warm start)
+		vector<int> genotype(individual *ind);
+		int hamming(const vector<int>& a, const vector<int>& b);
+		vector<int> similarityOrder(population *pop);
+		int nearestBasis(const vector<int>& genes);
+		void storeBasis(const vector<int>& genes, CPLEX& netplan);
 		
 		// Assign rank and crowding distance
 		void assignRankCrowdingDistance(population *new_pop);
@@ -79,6 +90,18 @@ class CNSGA2 {
 		void merge(population *pop1, population *pop2, population *pop3);
 		void copyInd(individual *ind1, individual *ind2);
 		
+		// Asynchronous steady-state evolution: one child for each evaluation that finishes, inserted in
+		// the parent population with an incremental non-dominated sort
+		void evolveAsync(const int children);
+		void makeChild(individual *child);
+		bool insertInd(population *pop, individual *ind);
+		void assignCrowdingDistanceVector(vector<individual*>& front);
+		
+		// Island model: copies 'count' migrants of the parents (best rank and crowding, or random) to
+		// the first individuals of 'out', and inserts the ones received from another island with insertInd
+		void emigrate(population *out, const int count, const string& select);
+		int immigrate(population *in, const int count);
+		
 		// Fill Non-dominated sort
 		void fillNondominatedSort(population *mixed_pop, population *new_pop);
 		void crowdingFill(population *mixed_pop, population *new_pop, int count, int front_size, list *elite);
@@ -115,6 +138,26 @@ class CNSGA2 {
 		population *child_pop;
 		population *mixed_pop;
 		
+		// Genotype of the last individual evaluated and cache of bases (genotype, basis and last use)
+		vector<int> lastGenes;
+		vector< vector<int> > cacheGenes;
+		vector<Basis> cacheBasis;
+		vector<long> cacheUse;
+		long cacheClock;
+		
+		// Objectives of the individuals already evaluated (evalcache), kept in nsgadata/eval_cache.csv
+		EvalCache evalCache;
+		
+		// Processes that evaluate the populations sent with sendPop (shared by several instances),
+		// and group, positions and metrics of the individuals sent for each population
+		EvalFarm* farm;
+		map<population*, int> farmBatch;
+		map<population*, vector<int> > farmSent;
+		map<population*, vector<string> > farmMetrics;
+		
+		// Solvers of the threads that evaluate a population (threads), besides the one of the caller
+		vector<CPLEX*> threadSolvers;
+		
 		// Helper classes
 		CRand* randgen;
 		CFileIO* fileio;
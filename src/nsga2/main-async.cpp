@@ -0,0 +1,86 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    Implementation of asynchronous steady-state NSGA-II
+//    2009-2011 (c) Eduardo Ibanez and others
+//    For more info:
+//        http://natek85.blogspot.com/2009/07/c-nsga2-code.html
+//        http://www.iitk.ac.in/kangal/codes.shtml
+// --------------------------------------------------------------
+
+using namespace std;
+#include "CNSGA2.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../netscore.h"
+#include "../farm.h"
+
+CNSGA2* nsga2 = new CNSGA2();
+
+int main (int argc, char **argv) {
+	printHeader("nsga-async");
+	
+	// Read global parameters
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
+	
+	// Read indices
+	ImportIndices(ctx);
+	
+	// Capacity losses for events
+	EventStore events = ReadEventStore(ctx, "prepdata/events.csv");
+	
+	// Evaluation processes, forked before the populations are created. Each one loads the problem
+	EvalFarm farm(ctx, events);
+	farm.Start(ctx.Nworkers);
+	
+	// -- Initialization -- //
+	nsga2->randgen->randomize();                    // Initialize random number generator
+	nsga2->Init("prepdata/param.in");               // This sets all variables related to GA
+	nsga2->InitMemory();                            // This allocates memory for the populations
+	nsga2->InitPop(nsga2->parent_pop, ctx.Np_start);    // Initialize parent population randomly
+	nsga2->fileio->recordConfiguration();           // Records all variables related to GA configuration
+	if (argc > 1) {
+		nsga2->ResumePop(nsga2->parent_pop, argv[1]);
+		fprintf(nsga2->fileio->fpt4,"# imported values\n");
+		nsga2->fileio->report_pop(nsga2->parent_pop, nsga2->fileio->fpt4);     // All pop out
+	}
+	nsga2->farm = &farm;
+	
+	cout << "- Initialization done, now performing first generation" << endl;
+	
+	// -- First generation, evaluated as a whole -- //
+	nsga2->decodePop(nsga2->parent_pop);
+	nsga2->sendPop(nsga2->parent_pop);
+	nsga2->receivePop(nsga2->parent_pop);
+	nsga2->assignRankCrowdingDistance(nsga2->parent_pop);
+	
+	nsga2->fileio->report_pop(nsga2->parent_pop, nsga2->fileio->fpt1);       // Initial pop out
+	
+	fprintf(nsga2->fileio->fpt4,"# gen = 1\n");
+	nsga2->fileio->report_pop(nsga2->parent_pop, nsga2->fileio->fpt4);         // All pop out
+	
+	cout << "- Finished generation #1" << endl;
+	nsga2->fileio->flushIO();
+	
+	// -- Go -- //
+	// The same number of evaluations as the generational version, but a new child is sent as soon as
+	// a worker is free and inserted in the population as soon as it is evaluated
+	nsga2->evolveAsync((nsga2->ngen - 1) * nsga2->popsize);
+	farm.Stop();
+	
+	cout << endl << "- Generations finished, now reporting solutions" << endl;
+	nsga2->fileio->report_pop(nsga2->parent_pop, nsga2->fileio->fpt2);
+	nsga2->fileio->report_feasible(nsga2->parent_pop, nsga2->fileio->fpt3);
+	if (nsga2->nreal!=0) {
+		fprintf(nsga2->fileio->fpt5, "\n Number of crossover of real variable = %d", nsga2->nrealcross);
+		fprintf(nsga2->fileio->fpt5, "\n Number of mutation of real variable = %d", nsga2->nrealmut);
+	}
+	if (nsga2->nbin!=0) {
+		fprintf(nsga2->fileio->fpt5, "\n Number of crossover of binary variable = %d", nsga2->nbincross);
+		fprintf(nsga2->fileio->fpt5, "\n Number of mutation of binary variable = %d", nsga2->nbinmut);
+	}
+	
+	printHeader("completed");
+	return (0);
+}
@@ -0,0 +1,156 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    Implementation of NSGA-II with several islands (populations with migration)
+//    2009-2011 (c) Eduardo Ibanez and others
+//    For more info:
+//        http://natek85.blogspot.com/2009/07/c-nsga2-code.html
+//        http://www.iitk.ac.in/kangal/codes.shtml
+// --------------------------------------------------------------
+
+using namespace std;
+#include "CNSGA2.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../netscore.h"
+#include "../farm.h"
+
+// Sends the migrants of every island to the islands given by the topology (ring: next island,
+// full: all the others, random: another island chosen by the sender). The migrants of all the
+// islands are copied first, so an island sends its individuals from before the exchange
+void Migrate(vector<CNSGA2*>& islands, const ModelContext& ctx, const int count) {
+	int N = islands.size();
+	for (int k=0; k < N; k++)
+		islands[k]->emigrate(islands[k]->child_pop, count, ctx.NmigSelect);
+	
+	vector<int> accepted(N, 0);
+	for (int k=0; k < N; k++) {
+		vector<int> to;
+		if (ctx.Nmigration == "full") {
+			for (int d=1; d < N; d++)
+				to.push_back((k + d) % N);
+		} else if (ctx.Nmigration == "random") {
+			to.push_back((k + islands[k]->randgen->rnd(1, N-1)) % N);
+		} else {
+			to.push_back((k + 1) % N);
+		}
+		for (unsigned int d=0; d < to.size(); d++)
+			accepted[to[d]] += islands[to[d]]->immigrate(islands[k]->child_pop, count);
+	}
+	
+	cout << "\tMigrants accepted:";
+	for (int k=0; k < N; k++)
+		cout << " " << accepted[k];
+	cout << endl;
+}
+
+int main (int argc, char **argv) {
+	printHeader("nsga-islands");
+	
+	// Read global parameters
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
+	
+	// Read indices
+	ImportIndices(ctx);
+	
+	// Capacity losses for events
+	EventStore events = ReadEventStore(ctx, "prepdata/events.csv");
+	
+	// Evaluation processes, forked before the populations are created. Each one loads the problem
+	EvalFarm farm(ctx, events);
+	farm.Start(ctx.Nworkers);
+	
+	// -- Initialization -- //
+	// Each island has its own seed; only the first one writes the output files
+	int N = max(ctx.Nislands, 2);
+	vector<CNSGA2*> islands(N);
+	for (int k=0; k < N; k++) {
+		islands[k] = new CNSGA2(k == 0, 1.0 - (double) k / N);
+		islands[k]->randgen->randomize();               // Initialize random number generator
+		islands[k]->Init("prepdata/param.in");          // This sets all variables related to GA
+		islands[k]->InitMemory();                       // This allocates memory for the populations
+		islands[k]->InitPop(islands[k]->parent_pop, ctx.Np_start);  // Initialize parent population randomly
+		islands[k]->farm = &farm;
+	}
+	CNSGA2* nsga2 = islands[0];
+	nsga2->fileio->recordConfiguration();               // Records all variables related to GA configuration
+	int migrants = min(ctx.Nmigrants, nsga2->popsize / 2);
+	int interval = max(ctx.NmigInterval, 1);
+	
+	cout << "- Initialization done, now performing first generation (" << N << " islands)" << endl;
+	
+	for (int i = 1; i <= nsga2->ngen; i++) {
+		printHeader("elapsed");
+		
+		// -- Send (i) -- //
+		// The individuals of all the islands are in the queue of the workers at the same time
+		for (int k=0; k < N; k++) {
+			population *pop = (i == 1) ? islands[k]->parent_pop : islands[k]->child_pop;
+			if (i > 1) {
+				islands[k]->selection(islands[k]->parent_pop, islands[k]->child_pop);
+				islands[k]->mutatePop(islands[k]->child_pop);
+			}
+			islands[k]->decodePop(pop);
+			islands[k]->sendPop(pop);
+		}
+		
+		// -- Receive (i) -- //
+		for (int k=0; k < N; k++) {
+			if (i == 1) {
+				islands[k]->receivePop(islands[k]->parent_pop);
+				islands[k]->assignRankCrowdingDistance(islands[k]->parent_pop);
+				fprintf(nsga2->fileio->fpt1,"# gen = 1 island %d\n", k+1);
+				nsga2->fileio->report_pop(islands[k]->parent_pop, nsga2->fileio->fpt1);  // Initial population
+			} else {
+				islands[k]->receivePop(islands[k]->child_pop);
+				islands[k]->merge(islands[k]->parent_pop, islands[k]->child_pop, islands[k]->mixed_pop);
+				islands[k]->fillNondominatedSort(islands[k]->mixed_pop, islands[k]->parent_pop);
+			}
+		}
+		
+		// -- Migration -- //
+		if ((i % interval == 0) && (i < nsga2->ngen) && (migrants > 0))
+			Migrate(islands, ctx, migrants);
+		
+		// -- Report (i) -- //
+		for (int k=0; k < N; k++) {
+			fprintf(nsga2->fileio->fpt4,"# gen = %d island %d\n", i, k+1);
+			nsga2->fileio->report_pop(islands[k]->parent_pop, nsga2->fileio->fpt4);
+		}
+		nsga2->fileio->flushIO();
+		cout << "- Finished generation #" << i << endl;
+	}
+	farm.Stop();
+	
+	// -- Merge the fronts of the islands -- //
+	// The best popsize individuals of all the islands, selected as the parents of a generation
+	population *final_pop = nsga2->child_pop;
+	for (int j=0; j < nsga2->popsize; j++)
+		nsga2->copyInd(&nsga2->parent_pop->ind[j], &final_pop->ind[j]);
+	for (int k=1; k < N; k++) {
+		nsga2->merge(final_pop, islands[k]->parent_pop, nsga2->mixed_pop);
+		nsga2->fillNondominatedSort(nsga2->mixed_pop, final_pop);
+	}
+	
+	// -- Report final solution -- //
+	nsga2->fileio->report_pop(final_pop, nsga2->fileio->fpt2);
+	nsga2->fileio->report_feasible(final_pop, nsga2->fileio->fpt3);
+	int realcross = 0, realmut = 0, bincross = 0, binmut = 0;
+	for (int k=0; k < N; k++) {
+		realcross += islands[k]->nrealcross; realmut += islands[k]->nrealmut;
+		bincross += islands[k]->nbincross; binmut += islands[k]->nbinmut;
+	}
+	if (nsga2->nreal != 0) {
+		fprintf(nsga2->fileio->fpt5,"\n Number of crossover of real variable = %d",realcross);
+		fprintf(nsga2->fileio->fpt5,"\n Number of mutation of real variable = %d",realmut);
+	}
+	if (nsga2->nbin != 0) {
+		fprintf(nsga2->fileio->fpt5,"\n Number of crossover of binary variable = %d",bincross);
+		fprintf(nsga2->fileio->fpt5,"\n Number of mutation of binary variable = %d",binmut);
+	}
+	
+	printHeader("completed");
+	return (0);
+}
@@ -1,6 +1,6 @@
 // --------------------------------------------------------------
 //    NETSCORE Version 2
-//    Implementation of parallel NSGA-II
+//    Implementation of parallel NSGA-II (evaluation in several local processes)
 //    2009-2011 (c) Eduardo Ibanez and others
 //    For more info:
 //        http://natek85.blogspot.com/2009/07/c-nsga2-code.html
@@ -13,6 +13,7 @@ using namespace std;
 #include <string>
 #include <vector>
 #include "../netscore.h"
+#include "../farm.h"
 
 CNSGA2* nsga2a = new CNSGA2(true, 1.0);
 CNSGA2* nsga2b = new CNSGA2(false, 0.33);
@@ -21,38 +22,55 @@ int main (int argc, char **argv) {
 	printHeader("nsga-parallel");
 	
 	// Read global parameters
-	ReadParameters("data/parameters.csv");
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
+	
+	// Read indices
+	ImportIndices(ctx);
+	
+	// Capacity losses for events
+	EventStore events = ReadEventStore(ctx, "prepdata/events.csv");
+	
+	// Evaluation processes, forked before the populations are created. Each one loads the problem
+	EvalFarm farm(ctx, events);
+	farm.Start(ctx.Nworkers);
 	
 	// -- Initialization of A -- //
 	nsga2a->randgen->randomize();                   // Initialize random number generator
 	nsga2a->Init("prepdata/param.in");              // This sets all variables related to GA
 	nsga2a->InitMemory();                           // This allocates memory for the populations
-	nsga2a->InitPop(nsga2a->parent_pop, Np_start);  // Initialize parent population randomly
+	nsga2a->InitPop(nsga2a->parent_pop, ctx.Np_start);  // Initialize parent population randomly
 	nsga2a->fileio->recordConfiguration();          // Records all variables related to GA configuration
+	nsga2a->farm = &farm;
 	
 	// -- Send 1A -- //
 	nsga2a->decodePop(nsga2a->parent_pop);
-	nsga2a->sendPop(nsga2a->parent_pop);											// JINXU: This function puts the individuals in the queue
+	nsga2a->sendPop(nsga2a->parent_pop);            // Puts the individuals in the queue of the workers
 	
 	// -- Initialization of B -- //
 	nsga2b->randgen->randomize();                   // Initialize random number generator
 	nsga2b->Init("prepdata/param.in");              // This sets all variables related to GA
 	nsga2b->InitMemory();                           // This allocates memory for the populations
-	nsga2b->InitPop(nsga2b->child_pop, Np_start);   // Initialize child population randomly
+	nsga2b->InitPop(nsga2b->child_pop, ctx.Np_start);   // Initialize child population randomly
+	nsga2b->farm = &farm;
 	
 	// -- Send 1B -- //
 	nsga2b->decodePop(nsga2b->child_pop);
-	nsga2b->sendPop(nsga2b->child_pop);												// JINXU: This function puts the individuals in the queue
+	nsga2b->sendPop(nsga2b->child_pop);
+	
+	cout << "- Initialization done, now performing first generation" << endl;
 	
 	for (int i = 1; i <= nsga2a->ngen; i++) {
+		printHeader("elapsed");
+		
 		// -- Receive (i)A -- //
 		if (i == 1) {
-			nsga2a->receivePop(nsga2a->parent_pop);									// JINXU: This function waits for the solution queue
+			nsga2a->receivePop(nsga2a->parent_pop);     // Waits for the objectives of the individuals
 			nsga2a->assignRankCrowdingDistance(nsga2a->parent_pop);
-			fprintf(nsga2a->fileio->fpt1,"# gen = 1A\n",i);
+			fprintf(nsga2a->fileio->fpt1,"# gen = 1A\n");
 			nsga2a->fileio->report_pop (nsga2a->parent_pop, nsga2a->fileio->fpt1);  // Initial population
 		} else {
-			nsga2a->receivePop(nsga2a->child_pop);									// JINXU: This function waits for the solution queue
+			nsga2a->receivePop(nsga2a->child_pop);
 			nsga2a->merge(nsga2b->parent_pop, nsga2a->child_pop, nsga2a->mixed_pop);
 			nsga2a->fillNondominatedSort(nsga2a->mixed_pop, nsga2a->parent_pop);
 		}
@@ -61,6 +79,7 @@ int main (int argc, char **argv) {
 		fprintf(nsga2a->fileio->fpt4,"# gen = %dA\n",i);
 		nsga2a->fileio->report_pop(nsga2a->parent_pop, nsga2a->fileio->fpt4);
 		nsga2a->fileio->flushIO();
+		cout << "- Finished generation #" << i << "A" << endl;
 		
 		if (i < nsga2a->ngen) {
 			// -- Generate and send (i+1)A -- //
@@ -71,10 +90,10 @@ int main (int argc, char **argv) {
 		}
 		
 		// -- Receive (i)B -- //
-		nsga2b->receivePop(nsga2b->child_pop);										// JINXU: This function waits for the solution queue
+		nsga2b->receivePop(nsga2b->child_pop);
 		if (i == 1) {
 			nsga2b->assignRankCrowdingDistance(nsga2b->child_pop);
-			fprintf(nsga2a->fileio->fpt1,"# gen = 1B\n",i);
+			fprintf(nsga2a->fileio->fpt1,"# gen = 1B\n");
 			nsga2a->fileio->report_pop(nsga2b->child_pop, nsga2a->fileio->fpt1);  // Initial population
 		}
 		nsga2b->merge(nsga2a->parent_pop, nsga2b->child_pop, nsga2b->mixed_pop);
@@ -84,15 +103,17 @@ int main (int argc, char **argv) {
 		fprintf(nsga2a->fileio->fpt4,"# gen = %dB\n",i);
 		nsga2a->fileio->report_pop(nsga2b->parent_pop, nsga2a->fileio->fpt4);
 		nsga2a->fileio->flushIO();
+		cout << "- Finished generation #" << i << "B" << endl;
 		
 		if (i < nsga2a->ngen) {
 			// -- Generate and send (i+1)B -- //
 			nsga2b->selection(nsga2b->parent_pop, nsga2b->child_pop);
 			nsga2b->mutatePop(nsga2b->child_pop);
 			nsga2b->decodePop(nsga2b->child_pop);
-			nsga2b->sendPop(nsga2b->child_pop);										// JINXU: This function puts the individuals in the queue
+			nsga2b->sendPop(nsga2b->child_pop);
 		}
 	}
+	farm.Stop();
 	
 	// -- Report final solution -- //
 	nsga2a->fileio->report_pop(nsga2b->parent_pop, nsga2a->fileio->fpt2);
@@ -22,30 +22,30 @@ int main (int argc, char **argv) {
 	printHeader("nsga-parallel");
 	
 	// Read global parameters
-	ReadParameters("data/parameters.csv");
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
 	
 	// Read indices
-	ImportIndices();
+	ImportIndices(ctx);
 	
 	// -- Initialization of A -- //
 	nsga2a->randgen->randomize();                   // Initialize random number generator
 	nsga2a->Init("prepdata/param.in");              // This sets all variables related to GA
 	nsga2a->InitMemory();                           // This allocates memory for the populations
-	nsga2a->InitPop(nsga2a->parent_pop, Np_start);  // Initialize parent population randomly
+	nsga2a->InitPop(nsga2a->parent_pop, ctx.Np_start);  // Initialize parent population randomly
 	nsga2a->fileio->recordConfiguration();          // Records all variables related to GA configuration
 	
 	// -- Initialization of B -- //
 	nsga2b->randgen->randomize();                   // Initialize random number generator
 	nsga2b->Init("prepdata/param.in");              // This sets all variables related to GA
 	nsga2b->InitMemory();                           // This allocates memory for the populations
-	nsga2b->InitPop(nsga2b->child_pop, Np_start);   // Initialize child population randomly
+	nsga2b->InitPop(nsga2b->child_pop, ctx.Np_start);   // Initialize child population randomly
 	
-	// Vector of capacity losses for events
-	double events[(SLength[0] + IdxCap.size) * (Nevents+1)];
-	ReadEvents(events, "prepdata/bend_events.csv");
+	// Capacity losses for events
+	EventStore events = ReadEventStore(ctx, "prepdata/events.csv");
 	
 	// Declare variables to store the optimization model
-	CPLEX netplan;
+	CPLEX netplan(ctx);
 	
 	// Read optimization problem and store it in memory
 	netplan.LoadProblem();
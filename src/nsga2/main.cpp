@@ -21,16 +21,17 @@ int main (int argc, char **argv) {
 	printHeader("nsga");
 	
 	// Read global parameters
-	ReadParameters("data/parameters.csv");
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
 	
 	// Read indices
-	ImportIndices();
+	ImportIndices(ctx);
 	
 	// -- Initialization -- //
 	nsga2->randgen->randomize();                    // Initialize random number generator
 	nsga2->Init("prepdata/param.in");               // This sets all variables related to GA
 	nsga2->InitMemory();                            // This allocates memory for the populations
-	nsga2->InitPop(nsga2->parent_pop, Np_start);    // Initialize parent population randomly
+	nsga2->InitPop(nsga2->parent_pop, ctx.Np_start);    // Initialize parent population randomly
 	nsga2->fileio->recordConfiguration();           // Records all variables related to GA configuration
 	if (argc > 1) {
 		nsga2->ResumePop(nsga2->parent_pop, argv[1]);
@@ -38,12 +39,11 @@ int main (int argc, char **argv) {
 		nsga2->fileio->report_pop(nsga2->parent_pop, nsga2->fileio->fpt4);     // All pop out
 	}
 	
-	// Vector of capacity losses for events
-	double events[(SLength[0] + IdxCap.size) * (Nevents+1)];
-	ReadEvents(events, "prepdata/bend_events.csv");
+	// Capacity losses for events
+	EventStore events = ReadEventStore(ctx, "prepdata/events.csv");
 	
 	// Declare variables to store the optimization model
-	CPLEX netplan;
+	CPLEX netplan(ctx);
 	
 	// Read optimization problem and store it in memory
 	netplan.LoadProblem();
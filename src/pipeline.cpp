@@ -0,0 +1,88 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    pipeline.cpp - Building and optimizing a problem in a single process, without intermediate files
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+using namespace std;
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "netscore.h"
+#include "solver.h"
+#include <sys/stat.h>
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+int main () {
+	printHeader("pipeline");
+
+	// Read global parameters
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
+
+	// Set output level so that Benders steps are reported on screen
+	if (ctx.outputLevel == 2) ctx.outputLevel = 1;
+
+	// Folder for the results (and the files of the preprocessor if requested)
+	mkdir("./prepdata", 0777);
+
+	// Build the problems in memory, indices and events stay in the context
+	vector<LPBlock> Blocks;
+	EventStore events;
+	BuildModel(ctx, &Blocks, events, ctx.useDebugFiles);
+	SetIndexStarts(ctx);
+
+	// Load master and subproblems, the blocks are not needed afterwards
+	CPLEX netplan(ctx);
+	netplan.LoadProblem(&Blocks);
+	vector<LPBlock>().swap(Blocks);
+
+	// Solve problem
+	double objective[ctx.Nobj];
+	netplan.SolveIndividual(objective, events, true);
+
+	// Report solutions if the problem is feasible
+	if (objective[0] < 1.0e29) {
+		vector<string> solstring(netplan.SolutionString());
+		WriteOutput(ctx, "prepdata/post_emissions.csv", ctx.IdxEm, solstring, "% Emissions");
+		WriteOutput(ctx, "prepdata/post_node_rm.csv", ctx.IdxRm, solstring, "% Reserve margins");
+		WriteOutput(ctx, "prepdata/post_arc_inv.csv", ctx.IdxInv, solstring, "% Investments");
+		WriteOutput(ctx, "prepdata/post_arc_cap.csv", ctx.IdxCap, solstring, "% Capacity");
+		WriteOutput(ctx, "prepdata/post_arc_flow.csv", ctx.IdxArc, solstring, "% Arc flows");
+		WriteOutput(ctx, "prepdata/post_node_ud.csv", ctx.IdxUd, solstring, "% Demand not served at nodes");
+		if (ctx.RepPeriods > 0) {
+			// Representative steps for a single period (the files above have the totals)
+			vector<string> flows(PeriodValues(ctx, ctx.IdxArc, solstring)), unserved(PeriodValues(ctx, ctx.IdxUd, solstring));
+			WriteOutput(ctx, "prepdata/post_arc_flow_period.csv", ctx.IdxArc, flows, "% Arc flows in one period");
+			WriteOutput(ctx, "prepdata/post_node_ud_period.csv", ctx.IdxUd, unserved, "% Demand not served at nodes in one period");
+		}
+
+		for (int i=0; i <= ctx.Nevents; ++i) {
+			vector<string> dualstring(netplan.SolutionDualString(i));
+			string file_name = "prepdata/post_nodal_dual_e" + ToString<int>(i) + ".csv";
+			WriteOutput(ctx, file_name.c_str(), ctx.IdxNode, dualstring, "% Dual variable at demand nodes");
+		}
+	}
+
+	// Convergence of the Benders decomposition
+	if (ctx.useBenders) {
+		ofstream outfile("prepdata/benders.csv");
+		outfile << "Iteration,Lower,Upper,Gap,Cuts,Stabilised" << endl;
+		outfile.precision(15);
+		for (unsigned int i = 0; i < netplan.Convergence.size(); ++i) {
+			for (unsigned int k = 0; k < netplan.Convergence[i].size(); ++k)
+				outfile << ((k > 0) ? "," : "") << netplan.Convergence[i][k];
+			outfile << endl;
+		}
+		outfile.close();
+	}
+	
+	cout << "- Values returned:" << endl;
+	for (int k = 0; k < ctx.Nobj; ++k)
+		cout << "\t" << objective[k] << endl;
+
+	printHeader("completed");
+	return 0;
+}
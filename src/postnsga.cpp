@@ -11,39 +11,40 @@ using namespace std;
 #include <vector>
 #include "netscore.h"
 #include "solver.h"
+#include "evalcache.h"
 
 int main (int argc, char **argv) {
 	printHeader("postnsga");
 	
 	// Read global parameters
-	ReadParameters("data/parameters.csv");
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
 	
 	// Set output level so that Benders steps are reported on screen
-	if (outputLevel == 2) outputLevel = 1;
+	if (ctx.outputLevel == 2) ctx.outputLevel = 1;
 	
 	// Import indices to export data
-	ImportIndices();
+	ImportIndices(ctx);
 	
 	// Declare variables to store the optimization model
-	CPLEX netplan;
+	CPLEX netplan(ctx);
 	
 	// Read master and subproblems
 	netplan.LoadProblem();
 	
-	// Vector of capacity losses for events
-	double events[(SLength[0] + IdxCap.size) * (Nevents+1)];
-	ReadEvents(events, "prepdata/bend_events.csv");
+	// Capacity losses for events
+	EventStore events = ReadEventStore(ctx, "prepdata/events.csv");
 	
 	// Read min, max, number of bits
-	double min[IdxNsga.size], max[IdxNsga.size];
-	int nbits[IdxNsga.size];
+	double min[ctx.IdxNsga.size], max[ctx.IdxNsga.size];
+	int nbits[ctx.IdxNsga.size];
 	FILE *file = fopen("prepdata/param.in", "r");
 	if (file != NULL) {
 		char line[10000];
 		for (int i=0; i < 10; ++i)
 			fgets(line, sizeof line, file);
 		
-		for (int i = 0; i < IdxNsga.size; i++) {
+		for (int i = 0; i < ctx.IdxNsga.size; i++) {
 			// The number of bits for binary variable i
 			fgets(line, sizeof line, file);
 			
@@ -59,6 +60,11 @@ int main (int argc, char **argv) {
 		fclose(file);
 	}
 	
+	// Individuals already evaluated by NSGA-II or a previous run
+	EvalCache cache;
+	if (ctx.NevalCache)
+		cache.Open("nsgadata/eval_cache.csv", ctx.IdxNsga.size, ctx.Nobj);
+	
 	// Open best_pop.out
 	char* t_read;
 	char line[256];
@@ -74,17 +80,17 @@ int main (int argc, char **argv) {
 		
 		// Header
 		myfile << "Cost";
-		for (int j=0; j < SustObj.size(); ++j)
-			myfile << "," << SustObj[j];
+		for (int j=0; j < ctx.SustObj.size(); ++j)
+			myfile << "," << ctx.SustObj[j];
 		myfile << ",Resil"; //,ConstViol,Rank,Crowd";
-		for (int j = 1; j <= Nevents; ++j)
+		for (int j = 1; j <= ctx.Nevents; ++j)
 			myfile << ",Event" << j;
-		for (int j = 0; j < SustMet.size(); ++j)
-			myfile << ",Total" << SustMet[j];
-		/*myfile << ",inv" << IdxInv.GetName(0);
-		for (int j=1; j < IdxInv.GetSize(); ++j)
-			if (IdxInv.GetName(j) != IdxInv.GetName(j-1))
-				myfile << ",inv" << IdxInv.GetName(j);*/
+		for (int j = 0; j < ctx.SustMet.size(); ++j)
+			myfile << ",Total" << ctx.SustMet[j];
+		/*myfile << ",inv" << ctx.IdxInv.GetName(0);
+		for (int j=1; j < ctx.IdxInv.GetSize(); ++j)
+			if (ctx.IdxInv.GetName(j) != ctx.IdxInv.GetName(j-1))
+				myfile << ",inv" << ctx.IdxInv.GetName(j);*/
 		myfile << endl;
 		
 		// Discard first two lines (comments)
@@ -108,16 +114,16 @@ int main (int argc, char **argv) {
 			
 			// Copy objectives
 			//myfile << tmp;
-			for (int j=1; j < Nobj; ++j) {
+			for (int j=1; j < ctx.Nobj; ++j) {
 				fscanf (file, "%s", tmp);
 				//myfile << "," << tmp;
 			}
 			
 			// Apply values in the array as LB for investment variables
-			int k = Nobj;
-			double lbValue[IdxNsga.size];
+			int k = ctx.Nobj;
+			double lbValue[ctx.IdxNsga.size];
 			
-			for (int i = 0; i < IdxNsga.size; ++i) {
+			for (int i = 0; i < ctx.IdxNsga.size; ++i) {
 				double actual = 0, maxim = 0;
 				float f;
 				for (int j=0; j < nbits[i]; ++j) {
@@ -138,30 +144,35 @@ int main (int argc, char **argv) {
 				//myfile << "," << tmp;
 			}
 			
-			// Solve problem
-			double objective[Nobj];
+			// Solve problem (if it is in the cache, only when the detailed results are needed)
+			double objective[ctx.Nobj];
 			string returnSolution = "";
-			netplan.SolveIndividual(objective, events, false, &returnSolution);
+			bool cached = ctx.NevalCache && cache.Find(lbValue, objective, &returnSolution);
+			if (!cached || ctx.NpostDetail) {
+				netplan.SolveIndividual(objective, events, false, &returnSolution);
+				if (ctx.NevalCache)
+					cache.Add(lbValue, objective, &returnSolution);
+			}
 			
 			// Write objectives
 			myfile << objective[0];
-			for (int j=1; j < Nobj; ++j) {
+			for (int j=1; j < ctx.Nobj; ++j) {
 				myfile << "," << objective[j];
 			}
 			
 			// Write returned string on file
 			myfile << returnSolution << endl;
 			
-			// Report solutions (should be made optional)
-			if (true) {
+			// Report solutions
+			if (ctx.NpostDetail) {
 				vector<string> solstring(netplan.SolutionString());
 				string base_name = "bestdata/" + ToString<int>(candidate);
-				WriteOutput((base_name + "_emissions.csv").c_str(), IdxEm, solstring, "% Emissions");
-				WriteOutput((base_name + "_node_rm.csv").c_str(), IdxRm, solstring, "% Reserve margins");
-				WriteOutput((base_name + "_arc_inv.csv").c_str(), IdxInv, solstring, "% Investments");
-				WriteOutput((base_name + "_arc_cap.csv").c_str(), IdxCap, solstring, "% Capacity");
-				WriteOutput((base_name + "_arc_flow.csv").c_str(), IdxArc, solstring, "% Arc flows");
-				WriteOutput((base_name + "_node_ud.csv").c_str(), IdxUd, solstring, "% Demand not served at nodes");
+				WriteOutput(ctx, (base_name + "_emissions.csv").c_str(), ctx.IdxEm, solstring, "% Emissions");
+				WriteOutput(ctx, (base_name + "_node_rm.csv").c_str(), ctx.IdxRm, solstring, "% Reserve margins");
+				WriteOutput(ctx, (base_name + "_arc_inv.csv").c_str(), ctx.IdxInv, solstring, "% Investments");
+				WriteOutput(ctx, (base_name + "_arc_cap.csv").c_str(), ctx.IdxCap, solstring, "% Capacity");
+				WriteOutput(ctx, (base_name + "_arc_flow.csv").c_str(), ctx.IdxArc, solstring, "% Arc flows");
+				WriteOutput(ctx, (base_name + "_node_ud.csv").c_str(), ctx.IdxUd, solstring, "% Demand not served at nodes");
 			}
 			
 			++candidate;
@@ -169,6 +180,7 @@ int main (int argc, char **argv) {
 		
 		// Close files
 		myfile.close();
+		cache.Flush();
 		fclose(file);
 	} else {
 		cout << endl;
@@ -18,47 +18,53 @@ int main () {
 	printHeader("postprocessor");
 	
 	// Read global parameters
-	ReadParameters("data/parameters.csv");
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
 	
 	// Set output level so that Benders steps are reported on screen
-	if (outputLevel == 2) outputLevel = 1;
+	if (ctx.outputLevel == 2) ctx.outputLevel = 1;
 	
 	// Import indices to export data
-	ImportIndices();
+	ImportIndices(ctx);
 	
 	// Declare variables to store the optimization model
-	CPLEX netplan;
+	CPLEX netplan(ctx);
 	
 	// Read master and subproblems
 	netplan.LoadProblem();
 	
-	// Vector of capacity losses for events
-	double events[(SLength[0] + IdxCap.size) * (Nevents+1)];
-	ReadEvents(events, "prepdata/bend_events.csv");
+	// Capacity losses for events
+	EventStore events = ReadEventStore(ctx, "prepdata/events.csv");
 	
 	// Solve problem
-	double objective[Nobj];
+	double objective[ctx.Nobj];
 	netplan.SolveIndividual(objective, events, true);
 	
 	// Report solutions if the problem is feasible
 	if (objective[0] < 1.0e29) {
 		vector<string> solstring(netplan.SolutionString());
-		WriteOutput("prepdata/post_emissions.csv", IdxEm, solstring, "% Emissions");
-		WriteOutput("prepdata/post_node_rm.csv", IdxRm, solstring, "% Reserve margins");
-		WriteOutput("prepdata/post_arc_inv.csv", IdxInv, solstring, "% Investments");
-		WriteOutput("prepdata/post_arc_cap.csv", IdxCap, solstring, "% Capacity");
-		WriteOutput("prepdata/post_arc_flow.csv", IdxArc, solstring, "% Arc flows");
-		WriteOutput("prepdata/post_node_ud.csv", IdxUd, solstring, "% Demand not served at nodes");
+		WriteOutput(ctx, "prepdata/post_emissions.csv", ctx.IdxEm, solstring, "% Emissions");
+		WriteOutput(ctx, "prepdata/post_node_rm.csv", ctx.IdxRm, solstring, "% Reserve margins");
+		WriteOutput(ctx, "prepdata/post_arc_inv.csv", ctx.IdxInv, solstring, "% Investments");
+		WriteOutput(ctx, "prepdata/post_arc_cap.csv", ctx.IdxCap, solstring, "% Capacity");
+		WriteOutput(ctx, "prepdata/post_arc_flow.csv", ctx.IdxArc, solstring, "% Arc flows");
+		WriteOutput(ctx, "prepdata/post_node_ud.csv", ctx.IdxUd, solstring, "% Demand not served at nodes");
+		if (ctx.RepPeriods > 0) {
+			// Representative steps for a single period (the files above have the totals)
+			vector<string> flows(PeriodValues(ctx, ctx.IdxArc, solstring)), unserved(PeriodValues(ctx, ctx.IdxUd, solstring));
+			WriteOutput(ctx, "prepdata/post_arc_flow_period.csv", ctx.IdxArc, flows, "% Arc flows in one period");
+			WriteOutput(ctx, "prepdata/post_node_ud_period.csv", ctx.IdxUd, unserved, "% Demand not served at nodes in one period");
+		}
 		
-		for (int i=0; i <= Nevents; ++i) {
+		for (int i=0; i <= ctx.Nevents; ++i) {
 			vector<string> dualstring(netplan.SolutionDualString(i));
 			string file_name = "prepdata/post_nodal_dual_e" + ToString<int>(i) + ".csv";
-			WriteOutput(file_name.c_str(), IdxNode, dualstring, "% Dual variable at demand nodes");
+			WriteOutput(ctx, file_name.c_str(), ctx.IdxNode, dualstring, "% Dual variable at demand nodes");
 		}
 	}
 	
 	cout << "- Values returned:" << endl;
-	for (int k = 0; k < Nobj; ++k)
+	for (int k = 0; k < ctx.Nobj; ++k)
 		cout << "\t" << objective[k] << endl;
 	
 	printHeader("completed");
@@ -16,11 +16,12 @@ using namespace std;
 
 #define CHAR_LINE 15000
 
-// Read global parameters
-void ReadParameters(const char* fileinput) {
+// Read global parameters. The values in 'values' replace the ones read for the parameters in 'names'
+void ReadParameters(ModelContext& ctx, const char* fileinput, const VectorStr& names, const VectorStr& values) {
 	char* t_read;
 	string prop, value, discount = "0", inflation = "0", demandrate = "0", peakdemandrate = "0";
 	char line[CHAR_LINE];
+	VectorStr props(0), items(0);
 	
 	FILE *file = fopen(fileinput, "r");
 	if (file != NULL) {
@@ -34,133 +35,188 @@ void ReadParameters(const char* fileinput) {
 			
 			if ((line[0] != '$') && (line[0] != '/') && (line[0] != '#') && (line[0] != '%')) {
 				t_read = strtok(line,",");
-				prop = string(t_read);
+				props.push_back(string(t_read));
 				t_read = strtok(NULL,",");
-				value = string(t_read);
-				
-				// Apply read item
-				if (prop == "StepName") SName = value;
-				else if (prop == "StepLength") SLength = Str2Step(value);
-				else if (prop == "StepHours") StepHours.push_back(value);
-				else if (prop == "UseDCFlow") useDCflow = (value == "true" || value == "True" || value == "TRUE");
-				else if (prop == "UseBenders") useBenders = (value == "true" || value == "True" || value == "TRUE");
-				else if (prop == "OutputLevel") outputLevel = atoi(value.c_str());
-				else if (prop == "CodeDC") DCCode = value;
-				else if (prop == "DefStep") DefStep = value;
-				else if (prop == "DefDiscount") discount = value;
-				else if (prop == "DefInflation") inflation = value;
-				else if (prop == "DefDemandRate") demandrate = value;
-				// Transportation parameters
-				else if (prop == "TransStep") TransStep = value;
-				else if (prop == "TransInfra") TransInfra.push_back(value);
-				else if (prop == "TransComm") TransComm.push_back(value);
-				else if (prop == "TransCoal") TransCoal = value;
-				// Sustainability metrics and objectives
-				else if (prop == "AddObj") SustObj.push_back(value);
-				else if (prop == "AddMetric") SustMet.push_back(value);
-				// Resiliency parameters
-				else if (prop == "NumberEvents") Nevents = atoi(value.c_str());
-				// NSGA-II parameters
-				else if (prop == "popsize") Npopsize = atoi(value.c_str());
-				else if (prop == "ngen") Nngen = atoi(value.c_str());
-				else if (prop == "pcross_real") Npcross_real = value;
-				else if (prop == "pmut_real") Npmut_real = value;
-				else if (prop == "eta_c") Neta_c = value;
-				else if (prop == "eta_m") Neta_m = value;
-				else if (prop == "pcross_bin") Npcross_bin = value;
-				else if (prop == "pmut_bin") Npmut_bin = value;
-				else if (prop == "stages") Nstages = value;
-				else if (prop == "pstart") Np_start = atof(value.c_str());
-				else { printError("parameter", prop); }
+				items.push_back(string(t_read));
 			}
 		}
 		fclose(file);
 	} else { printError("error", fileinput); }
 	
+	// Parameters given by the caller are applied after the file, so they take precedence
+	props.insert(props.end(), names.begin(), names.end());
+	items.insert(items.end(), values.begin(), values.end());
+	
+	for (unsigned int k = 0; k < props.size(); ++k) {
+		prop = props[k];
+		value = items[k];
+		
+		// Apply read item
+		if (prop == "StepName") ctx.SName = value;
+		else if (prop == "StepLength") ctx.SLength = Str2Step(ctx, value);
+		else if (prop == "StepHours") ctx.StepHours.push_back(value);
+		else if (prop == "UseDCFlow") ctx.useDCflow = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "UseBenders") ctx.useBenders = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "BinaryModel") ctx.useBinaryModel = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "CompactNames") ctx.useCompactNames = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "TextIndices") ctx.useTextIndices = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "DebugFiles") ctx.useDebugFiles = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "UseComponents") ctx.useComponents = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "UseRegions") ctx.useRegions = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "RepPeriods") ctx.RepPeriods = atoi(value.c_str());
+		else if (prop == "OutputLevel") ctx.outputLevel = atoi(value.c_str());
+		else if (prop == "BendersThreads") ctx.BendersThreads = atoi(value.c_str());
+		else if (prop == "SolverThreads") ctx.SolverThreads = atoi(value.c_str());
+		else if (prop == "ScreenEvents") ctx.useScreening = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "CutPool") ctx.useCutPool = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "CutMaxAge") ctx.CutMaxAge = atoi(value.c_str());
+		else if (prop == "CutSlack") ctx.CutSlack = atof(value.c_str());
+		else if (prop == "BendersMethod") ctx.BendersMethod = value;
+		else if (prop == "StabFactor") ctx.StabFactor = atof(value.c_str());
+		else if (prop == "TrustRadius") ctx.TrustRadius = atof(value.c_str());
+		else if (prop == "StabGap") ctx.StabGap = atof(value.c_str());
+		else if (prop == "CodeDC") ctx.DCCode = value;
+		else if (prop == "DefStep") ctx.DefStep = value;
+		else if (prop == "DefDiscount") discount = value;
+		else if (prop == "DefInflation") inflation = value;
+		else if (prop == "DefDemandRate") demandrate = value;
+		else if (prop == "OpCostScale") ctx.OpCostScale = atof(value.c_str());
+		else if (prop == "InvCostScale") ctx.InvCostScale = atof(value.c_str());
+		else if (prop == "LimitScale") ctx.LimitScale = atof(value.c_str());
+		// Transportation parameters
+		else if (prop == "TransStep") ctx.TransStep = value;
+		else if (prop == "TransInfra") ctx.TransInfra.push_back(value);
+		else if (prop == "TransComm") ctx.TransComm.push_back(value);
+		else if (prop == "TransCoal") ctx.TransCoal = value;
+		// Sustainability metrics and objectives
+		else if (prop == "AddObj") ctx.SustObj.push_back(value);
+		else if (prop == "AddMetric") ctx.SustMet.push_back(value);
+		// Resiliency parameters
+		else if (prop == "NumberEvents") ctx.Nevents = atoi(value.c_str());
+		// NSGA-II parameters
+		else if (prop == "popsize") ctx.Npopsize = atoi(value.c_str());
+		else if (prop == "ngen") ctx.Nngen = atoi(value.c_str());
+		else if (prop == "pcross_real") ctx.Npcross_real = value;
+		else if (prop == "pmut_real") ctx.Npmut_real = value;
+		else if (prop == "eta_c") ctx.Neta_c = value;
+		else if (prop == "eta_m") ctx.Neta_m = value;
+		else if (prop == "pcross_bin") ctx.Npcross_bin = value;
+		else if (prop == "pmut_bin") ctx.Npmut_bin = value;
+		else if (prop == "stages") ctx.Nstages = value;
+		else if (prop == "pstart") ctx.Np_start = atof(value.c_str());
+		else if (prop == "evalorder") ctx.NevalOrder = value;
+		else if (prop == "basiscache") ctx.NbasisCache = atoi(value.c_str());
+		else if (prop == "evalcache") ctx.NevalCache = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "prune") ctx.Nprune = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "postdetail") ctx.NpostDetail = (value == "true" || value == "True" || value == "TRUE");
+		else if (prop == "workers") ctx.Nworkers = atoi(value.c_str());
+		else if (prop == "threads") ctx.Nthreads = atoi(value.c_str());
+		else if (prop == "islands") ctx.Nislands = atoi(value.c_str());
+		else if (prop == "migration") ctx.Nmigration = value;
+		else if (prop == "miginterval") ctx.NmigInterval = atoi(value.c_str());
+		else if (prop == "migrants") ctx.Nmigrants = atoi(value.c_str());
+		else if (prop == "migselect") ctx.NmigSelect = value;
+		else { printError("parameter", prop); }
+	}
+	
 	// Calculate how many hours are there for each step and store it in StepHours
-	int laststep = SLength[SName.size()-1], temp_hour = 0;
-	if (StepHours.size() == 0) {
+	int laststep = ctx.SLength[ctx.SName.size()-1], temp_hour = 0;
+	if (ctx.StepHours.size() == 0) {
 		for (int i=0; i < laststep; ++i)
-			StepHours.push_back("1");
+			ctx.StepHours.push_back("1");
 		temp_hour = laststep;
-	} else if (StepHours.size() == laststep) {
+	} else if (ctx.StepHours.size() == laststep) {
 		for (int i=0; i < laststep; ++i)
-			temp_hour += atoi(StepHours[i].c_str());
+			temp_hour += atoi(ctx.StepHours[i].c_str());
 	} else {
-		if (StepHours.size() > 1)
+		if (ctx.StepHours.size() > 1)
 			printError("parameter", string("StepHours"));
-		for (int i=1; i < StepHours.size(); ++i)
-			StepHours[i] = StepHours[0];
-		for (int i=StepHours.size(); i < laststep; ++i)
-			StepHours.push_back(StepHours[0]);
-		temp_hour = laststep * atoi(StepHours[0].c_str());
+		for (int i=1; i < ctx.StepHours.size(); ++i)
+			ctx.StepHours[i] = ctx.StepHours[0];
+		for (int i=ctx.StepHours.size(); i < laststep; ++i)
+			ctx.StepHours.push_back(ctx.StepHours[0]);
+		temp_hour = laststep * atoi(ctx.StepHours[0].c_str());
 	}
-	for (int j = SName.size()-2; j >= 0; --j) {
-		StepHours.insert(StepHours.begin(), ToString<int>(temp_hour));
-		temp_hour = temp_hour * SLength[j];
+	for (int j = ctx.SName.size()-2; j >= 0; --j) {
+		ctx.StepHours.insert(ctx.StepHours.begin(), ToString<int>(temp_hour));
+		temp_hour = temp_hour * ctx.SLength[j];
+	}
+	
+	// Representative periods replace the steps of the level before the last one.
+	// The original lengths are kept in SFullLength to read the data
+	ctx.SFullLength = ctx.SLength;
+	if (ctx.RepPeriods > 0) {
+		if (ctx.SName.size() < 3) {
+			printError("parameter", string("RepPeriods"));
+			ctx.RepPeriods = 0;
+		} else if (ctx.RepPeriods >= ctx.SLength[ctx.SName.size()-2]) {
+			ctx.RepPeriods = 0;
+		} else {
+			ctx.SLength[ctx.SName.size()-2] = ctx.RepPeriods;
+		}
 	}
 	
 	// Number of objectives
-	Nobj = 1 + SustObj.size();
-	if (Nevents > 0)
-		++Nobj;
-	SustMet.insert(SustMet.begin(), SustObj.begin(), SustObj.end());
+	ctx.Nobj = 1 + ctx.SustObj.size();
+	if (ctx.Nevents > 0)
+		++ctx.Nobj;
+	ctx.SustMet.insert(ctx.SustMet.begin(), ctx.SustObj.begin(), ctx.SustObj.end());
 	
 	// Declare a vector with the node property codes
-	NodeProp.push_back("Code"); NodeDefault.push_back("X");
-	NodeProp.push_back("ShortCode"); NodeDefault.push_back("X");
-	NodeProp.push_back("Step"); NodeDefault.push_back(DefStep);
-	NodeProp.push_back("StepLength"); NodeDefault.push_back("X");
-	NodeProp.push_back("Demand"); NodeDefault.push_back("0");
-	NodeProp.push_back("DemandPower"); NodeDefault.push_back("X");
-	NodeProp.push_back("DemandRate"); NodeDefault.push_back(demandrate);
-	NodeProp.push_back("PeakPower"); NodeDefault.push_back("X");
-	NodeProp.push_back("PeakPowerRate"); NodeDefault.push_back(peakdemandrate);
-	NodeProp.push_back("CostUD"); NodeDefault.push_back("X");
-	NodeProp.push_back("DiscountRate"); NodeDefault.push_back(discount);
-	NodeProp.push_back("InflationRate"); NodeDefault.push_back(inflation);
-	NodePropOffset = 4;
+	ctx.NodeProp.push_back("Code"); ctx.NodeDefault.push_back("X");
+	ctx.NodeProp.push_back("ShortCode"); ctx.NodeDefault.push_back("X");
+	ctx.NodeProp.push_back("Step"); ctx.NodeDefault.push_back(ctx.DefStep);
+	ctx.NodeProp.push_back("StepLength"); ctx.NodeDefault.push_back("X");
+	ctx.NodeProp.push_back("Demand"); ctx.NodeDefault.push_back("0");
+	ctx.NodeProp.push_back("DemandPower"); ctx.NodeDefault.push_back("X");
+	ctx.NodeProp.push_back("DemandRate"); ctx.NodeDefault.push_back(demandrate);
+	ctx.NodeProp.push_back("PeakPower"); ctx.NodeDefault.push_back("X");
+	ctx.NodeProp.push_back("PeakPowerRate"); ctx.NodeDefault.push_back(peakdemandrate);
+	ctx.NodeProp.push_back("CostUD"); ctx.NodeDefault.push_back("X");
+	ctx.NodeProp.push_back("DiscountRate"); ctx.NodeDefault.push_back(discount);
+	ctx.NodeProp.push_back("InflationRate"); ctx.NodeDefault.push_back(inflation);
+	ctx.NodePropOffset = 4;
 	
 	// Declare a vector with the arc property codes
-	string startzero = SName.substr(0,1) + "2";
-	ArcProp.push_back("Code"); ArcDefault.push_back("X");
-	ArcProp.push_back("From"); ArcDefault.push_back("X");
-	ArcProp.push_back("To"); ArcDefault.push_back("X");
-	ArcProp.push_back("FromStep"); ArcDefault.push_back(DefStep);
-	ArcProp.push_back("ToStep"); ArcDefault.push_back(DefStep);
-	ArcProp.push_back("StepLength"); ArcDefault.push_back("X");
-	ArcProp.push_back("InvStep"); ArcDefault.push_back(SName.substr(0,1));
-	ArcProp.push_back("TransInfr"); ArcDefault.push_back("");
-	ArcProp.push_back("OpCost"); ArcDefault.push_back("0");
-	ArcProp.push_back("InvCost"); ArcDefault.push_back("X");
-	ArcProp.push_back("DiscountRate"); ArcDefault.push_back(discount);
-	ArcProp.push_back("InflationRate"); ArcDefault.push_back(inflation);
-	ArcProp.push_back("Distance"); ArcDefault.push_back("X");
-	ArcProp.push_back("OpMin"); ArcDefault.push_back("0");
-	ArcProp.push_back("OpMax"); ArcDefault.push_back("Inf");
-	ArcProp.push_back("InvMin"); ArcDefault.push_back("0");
-	ArcProp.push_back("InvMax"); ArcDefault.push_back("Inf");
-	ArcProp.push_back("InvStart"); ArcDefault.push_back(startzero);
-	ArcProp.push_back("LifeSpan"); ArcDefault.push_back("X");
-	ArcProp.push_back("Eff"); ArcDefault.push_back("1");
-	ArcProp.push_back("InvertEff"); ArcDefault.push_back("N");
-	ArcProp.push_back("Suscep"); ArcDefault.push_back("X");
-	ArcProp.push_back("CapacityFactor"); ArcDefault.push_back("0");
+	string startzero = ctx.SName.substr(0,1) + "2";
+	ctx.ArcProp.push_back("Code"); ctx.ArcDefault.push_back("X");
+	ctx.ArcProp.push_back("From"); ctx.ArcDefault.push_back("X");
+	ctx.ArcProp.push_back("To"); ctx.ArcDefault.push_back("X");
+	ctx.ArcProp.push_back("FromStep"); ctx.ArcDefault.push_back(ctx.DefStep);
+	ctx.ArcProp.push_back("ToStep"); ctx.ArcDefault.push_back(ctx.DefStep);
+	ctx.ArcProp.push_back("StepLength"); ctx.ArcDefault.push_back("X");
+	ctx.ArcProp.push_back("InvStep"); ctx.ArcDefault.push_back(ctx.SName.substr(0,1));
+	ctx.ArcProp.push_back("TransInfr"); ctx.ArcDefault.push_back("");
+	ctx.ArcProp.push_back("OpCost"); ctx.ArcDefault.push_back("0");
+	ctx.ArcProp.push_back("InvCost"); ctx.ArcDefault.push_back("X");
+	ctx.ArcProp.push_back("DiscountRate"); ctx.ArcDefault.push_back(discount);
+	ctx.ArcProp.push_back("InflationRate"); ctx.ArcDefault.push_back(inflation);
+	ctx.ArcProp.push_back("Distance"); ctx.ArcDefault.push_back("X");
+	ctx.ArcProp.push_back("OpMin"); ctx.ArcDefault.push_back("0");
+	ctx.ArcProp.push_back("OpMax"); ctx.ArcDefault.push_back("Inf");
+	ctx.ArcProp.push_back("InvMin"); ctx.ArcDefault.push_back("0");
+	ctx.ArcProp.push_back("InvMax"); ctx.ArcDefault.push_back("Inf");
+	ctx.ArcProp.push_back("InvStart"); ctx.ArcDefault.push_back(startzero);
+	ctx.ArcProp.push_back("LifeSpan"); ctx.ArcDefault.push_back("X");
+	ctx.ArcProp.push_back("Eff"); ctx.ArcDefault.push_back("1");
+	ctx.ArcProp.push_back("InvertEff"); ctx.ArcDefault.push_back("N");
+	ctx.ArcProp.push_back("Suscep"); ctx.ArcDefault.push_back("X");
+	ctx.ArcProp.push_back("CapacityFactor"); ctx.ArcDefault.push_back("0");
 	// Sustainability
-	for (int j = 0; j < SustMet.size(); ++j) { ArcProp.push_back("Op" + SustMet[j]); ArcDefault.push_back("0"); }
+	for (int j = 0; j < ctx.SustMet.size(); ++j) { ctx.ArcProp.push_back("Op" + ctx.SustMet[j]); ctx.ArcDefault.push_back("0"); }
 	// Resiliency events
-	for (int j = 1; j <= Nevents; ++j) {
-		ArcProp.push_back("CapacityLoss" + ToString<int>(j)); ArcDefault.push_back("1");
+	for (int j = 1; j <= ctx.Nevents; ++j) {
+		ctx.ArcProp.push_back("CapacityLoss" + ToString<int>(j)); ctx.ArcDefault.push_back("1");
 	}
 	
-	ArcPropOffset = 8;
+	ctx.ArcPropOffset = 8;
 }
 
 // Read properties file and store it in a matrix of strings.
 // The first 'num_fields' columns are copied and not touched.
 // The rest of the columns correspond to the different 'Steps' as determined by the function 'Step2Pos'
-MatrixStr ReadProperties(const char* fileinput, const string& defvalue, const int num_fields) {
-	VectorStr Values(Step2Pos(SLength) + num_fields + 1), Header(0);
+MatrixStr ReadProperties(const ModelContext& ctx, const char* fileinput, const string& defvalue, const int num_fields) {
+	VectorStr Values(Step2Pos(ctx, ctx.SLength) + num_fields + 1), Header(0);
 	MatrixStr output(0);
 	char* t_read;
 	string t2_read;
@@ -216,26 +272,26 @@ MatrixStr ReadProperties(const char* fileinput, const string& defvalue, const in
 							if (Header[k-num_fields] == "const") {
 								for (unsigned int m = num_fields; m < Values.size(); m++)  Values[m] = t2_read;
 							} else {
-								Step Temp_Step = Str2Step(Header[k-num_fields]);
+								Step Temp_Step = Str2Step(ctx, Header[k-num_fields]);
 								if (Temp_Step[0] == 0) {
 									// Step is smaller than a year (to repeat monthly data, etc.)
-									Step Temp_Begin(SName.size(), 0);
+									Step Temp_Begin(ctx.SName.size(), 0);
 									bool zeros = true;
-									for (int l = 0; (l < SName.size()) & zeros; ++l) {
+									for (int l = 0; (l < ctx.SName.size()) & zeros; ++l) {
 										if (Temp_Step[l] == 0)
 											Temp_Begin[l] = 1;
 										else
 											zeros = false;
 									}
-									while (Temp_Begin < SLength) {
-										int m = Step2Pos(StepSum(Temp_Step, Temp_Begin)) + num_fields;
+									while (Temp_Begin < ctx.SLength) {
+										int m = Step2Pos(ctx, StepSum(ctx, Temp_Step, Temp_Begin)) + num_fields;
 										Values[m] = t2_read;
-										Temp_Begin = NextStep(Temp_Begin);
+										Temp_Begin = NextStep(ctx, Temp_Begin);
 									}
 								} else if (Temp_Step[0] > 0) {
 									// Step with year
-									int a = Step2Pos(Temp_Step) + num_fields;
-									int b = Step2Pos(NextStep(Temp_Step)) + num_fields;
+									int a = Step2Pos(ctx, Temp_Step) + num_fields;
+									int b = Step2Pos(ctx, NextStep(ctx, Temp_Step)) + num_fields;
 									for (int m = a; (m < b) && (m < Values.size()); m++)  Values[m] = t2_read;
 								}
 							}
@@ -248,13 +304,13 @@ MatrixStr ReadProperties(const char* fileinput, const string& defvalue, const in
 			}
 		}
 		fclose(file);
-	} else printError("warning", fileinput);
+	} else if (ctx.outputLevel < 3) printError("warning", fileinput);
 	return output;
 }
 
 // Read Node list and store it in a vector of 'Nodes' (only 'ShortCode' is stored)
-vector<Node> ReadListNodes(const char* fileinput) {
-	vector<Node> output(0);
+vector<Node> ReadListNodes(const ModelContext& ctx, const char* fileinput) {
+	vector<Node> output;
 	char* t_read;
 	char line[CHAR_LINE];
 	int i = 0;
@@ -271,7 +327,7 @@ vector<Node> ReadListNodes(const char* fileinput) {
 			
 			// Skip first line
 			if ((i!=0 && line[0]!='%') && (line[0]!='\0')) {
-				Node Temp_Node;
+				Node Temp_Node(ctx);
 				t_read = strtok(line,",");
 				Temp_Node.Set("ShortCode", string(t_read));
 				output.push_back(Temp_Node);
@@ -284,7 +340,7 @@ vector<Node> ReadListNodes(const char* fileinput) {
 }
 
 // Read Step list and store it in a matrix of strings
-MatrixStr ReadStep(const char* fileinput) {
+MatrixStr ReadStep(const ModelContext& ctx, const char* fileinput) {
 	MatrixStr output(0);
 	VectorStr Temp_Vector(2);
 	//char* t_read;
@@ -320,13 +376,45 @@ MatrixStr ReadStep(const char* fileinput) {
 			i++;
 		}
 		fclose(file);
-	} else printError("warning", fileinput);
+	} else if (ctx.outputLevel < 3) printError("warning", fileinput);
+	return output;
+}
+
+// Read a table of comma separated values, including its header (first row)
+MatrixStr ReadTable(const ModelContext& ctx, const char* fileinput) {
+	MatrixStr output(0);
+	char line[CHAR_LINE];
+	
+	FILE *file = fopen(fileinput, "r");
+	if (file != NULL) {
+		for (;;) {
+			// Read a line from the file and finish if empty is read
+			if (fgets(line, sizeof line, file) == NULL)
+				break;
+			
+			// Remove newline character
+			CleanLine(line);
+			
+			if ((line[0]!='%') && (line[0]!='\0')) {
+				VectorStr Temp_Vector(0);
+				const char *str = line;
+				size_t start = 0, end;
+				do {
+					end = strcspn(str + start, ",");
+					Temp_Vector.push_back(string(line).substr(start, end));
+					start += end + 1;
+				} while (str[start - 1] != '\0');
+				output.push_back(Temp_Vector);
+			}
+		}
+		fclose(file);
+	} else if (ctx.outputLevel < 3) printError("warning", fileinput);
 	return output;
 }
 
 // Read Arc list and store in a vector of 'Arcs' (Only 'From' and 'To' codes are stored)
-vector<Arc> ReadListArcs(const char* fileinput) {
-	vector<Arc> output(0);
+vector<Arc> ReadListArcs(const ModelContext& ctx, const char* fileinput) {
+	vector<Arc> output;
 	char* t_read;
 	char line[CHAR_LINE];
 	int i = 0;
@@ -343,7 +431,7 @@ vector<Arc> ReadListArcs(const char* fileinput) {
 			
 			// Skip first line, then read the rest
 			if ((i!=0) && (line[0]!='%') && (line[0]!='\0')) {
-				Arc Temp_Arc;
+				Arc Temp_Arc(ctx);
 				t_read = strtok(line,",");
 				Temp_Arc.Set("From", string(t_read));
 				t_read = strtok(NULL,",");
@@ -362,41 +450,41 @@ vector<Arc> ReadListArcs(const char* fileinput) {
 }
 
 // Read and create transportation network
-void ReadTrans(vector<Node>& Nodes, vector<Arc>& Arcs, const char* fileinput) {
+void ReadTrans(const ModelContext& ctx, vector<Node>& Nodes, vector<Arc>& Arcs, const char* fileinput) {
 	// Create default nodes and arcs
 	vector<string> DefNodes(0), DefFrom(0), DefTo(0), DefInf(0);
-	Node TempNode;
-	Arc TempArc;
-	int NInfra = TransInfra.size(), NFleet = 0, NComm = TransComm.size(), k = 0;
+	Node TempNode(ctx);
+	Arc TempArc(ctx);
+	int NInfra = ctx.TransInfra.size(), NFleet = 0, NComm = ctx.TransComm.size(), k = 0;
 	string Infra = "", Fleet = "", FleetInf = "", Comm = "", Coal = "";
 	
 	// Determine the number of fleet
 	for (unsigned int i = 0; i < NInfra; ++i)
-		NFleet += TransInfra[i].size()-1;
+		NFleet += ctx.TransInfra[i].size()-1;
 	
 	vector< vector<bool> > NodeTable(0), ArcTable(0);
 	vector<bool> TableColumn(NFleet, false);
 	
 	// For each line in the definition of infrastructures
 	for (unsigned int i = 0; i < NInfra; ++i) {
-		Infra.push_back(TransInfra[i][0]);
+		Infra.push_back(ctx.TransInfra[i][0]);
 		
 		// Create an arc (for infrastructure capacity constraints)
-		DefFrom.push_back(TransInfra[i].substr(0,1) + TransInfra[i].substr(0,1));
+		DefFrom.push_back(ctx.TransInfra[i].substr(0,1) + ctx.TransInfra[i].substr(0,1));
 		DefTo.push_back("XX");
 		DefInf.push_back("");
 		ArcTable.push_back(TableColumn);
 		
 		// For each fleet within that infrastructure
-		for (unsigned int j = 1; j < TransInfra[i].size(); ++j) {
+		for (unsigned int j = 1; j < ctx.TransInfra[i].size(); ++j) {
 			// Create an arc (for fleet capacity constraints)
-			DefFrom.push_back(TransInfra[i].substr(j,1) + TransInfra[i].substr(j,1));
+			DefFrom.push_back(ctx.TransInfra[i].substr(j,1) + ctx.TransInfra[i].substr(j,1));
 			DefTo.push_back("XX");
 			DefInf.push_back("");
 			ArcTable.push_back(TableColumn);
 			
-			Fleet.push_back(TransInfra[i][j]);
-			FleetInf.push_back(TransInfra[i][0]);
+			Fleet.push_back(ctx.TransInfra[i][j]);
+			FleetInf.push_back(ctx.TransInfra[i][0]);
 			
 			ArcTable[ArcTable.size()-1][k] = true;
 			ArcTable[ArcTable.size()-j-1][k] = true;
@@ -406,17 +494,17 @@ void ReadTrans(vector<Node>& Nodes, vector<Arc>& Arcs, const char* fileinput) {
 	
 	// For each commodity
 	for (unsigned int i = 0; i < NComm; ++i) {
-		Comm.push_back(TransComm[i][0]);
-		DefNodes.push_back(TransComm[i].substr(0,1) + "T");
+		Comm.push_back(ctx.TransComm[i][0]);
+		DefNodes.push_back(ctx.TransComm[i].substr(0,1) + "T");
 		NodeTable.push_back(TableColumn);
 		
-		for (unsigned int j = 1; j < TransComm[i].size(); ++j) {
+		for (unsigned int j = 1; j < ctx.TransComm[i].size(); ++j) {
 			// Find for each fleet that the commodity can use
-			k = Fleet.find(TransComm[i][j]);
+			k = Fleet.find(ctx.TransComm[i][j]);
 			if (k >= 0) {
 				// Create arc
 				DefFrom.push_back(Fleet.substr(k,1) + Fleet.substr(k,1));
-				DefTo.push_back(TransComm[i].substr(0,1) + "T");
+				DefTo.push_back(ctx.TransComm[i].substr(0,1) + "T");
 				DefInf.push_back(FleetInf.substr(k,1) + FleetInf.substr(k,1));
 				ArcTable.push_back(TableColumn);
 				
@@ -430,9 +518,9 @@ void ReadTrans(vector<Node>& Nodes, vector<Arc>& Arcs, const char* fileinput) {
 	char line[CHAR_LINE];
 	int i = 0;
 	
-	TempNode.Set("Step", TransStep);
-	TempArc.Set("FromStep", TransStep);
-	TempArc.Set("ToStep", TransStep);
+	TempNode.Set("Step", ctx.TransStep);
+	TempArc.Set("FromStep", ctx.TransStep);
+	TempArc.Set("ToStep", ctx.TransStep);
 	
 	FILE *file = fopen(fileinput, "r");
 	if (file != NULL) {
@@ -491,8 +579,8 @@ void ReadTrans(vector<Node>& Nodes, vector<Arc>& Arcs, const char* fileinput) {
 							Nodes.push_back(TempNode);
 							
 							//Coal to transportation
-							if ((swapindex==0) && (from!=to) && (DefNodes[k1]!=TransDummy) && (DefNodes[k1][1]=='T')) {
-								kk = TransCoal.find(DefNodes[k1][0]);
+							if ((swapindex==0) && (from!=to) && (DefNodes[k1]!=ctx.TransDummy) && (DefNodes[k1][1]=='T')) {
+								kk = ctx.TransCoal.find(DefNodes[k1][0]);
 								if (kk >= 0) {
 									// Check if nodes exist, if not it creates it
 									bool fromexists = false, toexists = false;
@@ -544,31 +632,3 @@ void ReadTrans(vector<Node>& Nodes, vector<Arc>& Arcs, const char* fileinput) {
 		fclose(file);
 	} else { printError("error", fileinput); }
 }
-
-// Read step lengths for capacitated arcs
-void ReadEvents(double output[], const char* fileinput) {
-	char* t_read;
-	char line[CHAR_LINE];
-	int i = 0;
-	
-	FILE *file = fopen(fileinput, "r");
-	if (file != NULL) {
-		for (;;) {
-			// Read a line from the file and finish if empty is read
-			if (fgets(line, sizeof line, file) == NULL)
-				break;
-			
-			// Remove comments and end of line characters
-			CleanLine(line);
-			t_read = strtok(line,",");
-			output[i] = atof(t_read);
-			++i;
-			for (int j=1; j<=Nevents; ++j) {
-				t_read = strtok(NULL,",");
-				output[i] = atof(t_read);
-				++i;
-			}
-		}
-		fclose(file);
-	} else printError("error", fileinput);
-}
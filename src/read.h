@@ -10,12 +10,12 @@
 #include "node.h"
 #include "arc.h"
 
-void ReadParameters(const char* fileinput);
-vector<Node> ReadListNodes(const char* fileinput);
-vector<Arc> ReadListArcs(const char* fileinput);
-MatrixStr ReadStep(const char* fileinput);
-MatrixStr ReadProperties(const char* fileinput, const string& defvalue, const int num_fields);
-void ReadTrans(vector<Node>& Nodes, vector<Arc>& Arcs, const char* fileinput);
-void ReadEvents(double output[], const char* fileinput);
+void ReadParameters(ModelContext& ctx, const char* fileinput, const VectorStr& names = VectorStr(), const VectorStr& values = VectorStr());
+vector<Node> ReadListNodes(const ModelContext& ctx, const char* fileinput);
+vector<Arc> ReadListArcs(const ModelContext& ctx, const char* fileinput);
+MatrixStr ReadStep(const ModelContext& ctx, const char* fileinput);
+MatrixStr ReadProperties(const ModelContext& ctx, const char* fileinput, const string& defvalue, const int num_fields);
+MatrixStr ReadTable(const ModelContext& ctx, const char* fileinput);
+void ReadTrans(const ModelContext& ctx, vector<Node>& Nodes, vector<Arc>& Arcs, const char* fileinput);
 
 #endif  // _READ_H_
@@ -9,35 +9,78 @@ using namespace std;
 #include <fstream>
 #include <string>
 #include <vector>
+#include <map>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <pthread.h>
 #include "global.h"
 #include "index.h"
 #include "read.h"
 #include "write.h"
+#include "mps.h"
 #include "solver.h"
 
 #define MAX_ITER 1000
 
-// Loads the problem from MPS files into memory
-void CPLEX::LoadProblem() {
-	cout << "- Reading problem..." << endl;
+// Work shared by the threads that solve subproblems. Each thread takes the next year of the list
+struct SubproblemWork {
+	CPLEX* problem;
+	int (CPLEX::*task)(const int);
+	const vector<int>* years;
+	vector<int>* result;
+	unsigned int next;
+	pthread_mutex_t lock;
+};
+
+void* SubproblemWorker(void* arg) {
+	SubproblemWork* work = (SubproblemWork*) arg;
+	for (;;) {
+		pthread_mutex_lock(&work->lock);
+		unsigned int n = work->next++;
+		pthread_mutex_unlock(&work->lock);
+		if (n >= work->years->size())
+			break;
+		(*work->result)[n] = (work->problem->*(work->task))((*work->years)[n]);
+	}
+	return NULL;
+}
+
+// Loads the problem from MPS files (or the binary model) into memory. If 'blocks' is given, the
+// problems built in memory are used instead (block 0 is the single problem, i+1 the Benders problem i)
+void CPLEX::LoadProblem(const vector<LPBlock>* blocks) {
+	cout << ((blocks == NULL) ? "- Reading problem..." : "- Loading problem...") << endl;
 	
 	try {
-		int nyears = SLength[0];
+		int nyears = ctx.SLength[0];
+		
+		// Subproblems solved in parallel need their own environment (Concert is not thread safe)
+		SubEnv.assign(1, env);
+		for (int i=1; i <= nyears; ++i)
+			SubEnv.push_back((ctx.BendersThreads > 1) ? IloEnv() : env);
+		SimplexIter.assign(nyears + 1, 0);
+		VarLB.assign(nyears + 1, vector<double>());
+		VarUB.assign(nyears + 1, vector<double>());
 		
 		for (int i=0; i <= nyears; ++i) {
-			model.add(IloModel(env));
-			cplex.add (IloCplex(env));
-			obj.add(IloObjective(env));
-			var.add(IloNumVarArray(env));
-			rng.add(IloRangeArray(env));
+			model.add(IloModel(SubEnv[i]));
+			cplex.add (IloCplex(SubEnv[i]));
+			obj.add(IloObjective(SubEnv[i]));
+			var.add(IloNumVarArray(SubEnv[i]));
+			rng.add(IloRangeArray(SubEnv[i]));
 			dualsolution.add(IloNumArray(env));
-			TempNumArray.add(IloNumArray(env));
+			TempNumArray.add(IloNumArray(SubEnv[i]));
+			DualArray.add(IloNumArray(SubEnv[i]));
 		}
 		
 		// Read MPS files
 		for (int i=0; i <= nyears; ++i) {
 			string file_name = "";
-			if (!useBenders && (i == 0)) {
+			if (ctx.useBinaryModel) {
+				file_name = "prepdata/netscore.bin";
+			} else if (!ctx.useBenders && (i == 0)) {
 				file_name = "prepdata/netscore.mps";
 			} else {
 				file_name = "prepdata/bend_" + ToString<int>(i) + ".mps";
@@ -46,17 +89,755 @@ void CPLEX::LoadProblem() {
 				//cplex[i].setParam(IloCplex::PreInd, 0);
 				//cplex[i].setParam(IloCplex::ScaInd, -1);
 				cplex[i].setParam(IloCplex::RootAlg, IloCplex::Dual);
+				if (ctx.SolverThreads > 0)
+					cplex[i].setParam(IloCplex::Threads, ctx.SolverThreads);
 			}
-			if (outputLevel > 0) {
+			if (ctx.outputLevel > 0) {
 				cplex[i].setOut(env.getNullStream());
-			} else {
+			} else if (blocks == NULL) {
 				cout << "Reading " << file_name << endl;
 			}
-			cplex[i].importModel(model[i], file_name.c_str(), obj[i], var[i], rng[i]);
+			if (blocks != NULL) {
+				// Subproblems sharing the structure of another block only store their values
+				const LPBlock& block = (*blocks)[(!ctx.useBenders && (i == 0)) ? 0 : i+1];
+				LoadBlock(i, block, (block.templ >= 0) ? (*blocks)[block.templ] : block);
+			} else if (ctx.useBinaryModel) {
+				// Block 0 is the single problem, the Benders problems start at block 1
+				LPBlock block;
+				int block_index = (!ctx.useBenders && (i == 0)) ? 0 : i+1;
+				if (!ReadModelFile(file_name.c_str(), block_index, block)) {
+					// The case cannot be solved without this problem
+					cout << "\tERROR: Block " << block_index << " of '" << file_name << "' could not be read" << endl;
+					exit(1);
+				}
+				LoadBlock(i, block);
+			} else {
+				cplex[i].importModel(model[i], file_name.c_str(), obj[i], var[i], rng[i]);
+			}
 			
 			// Extract models
 			cplex[i].extract(model[i]);
+			StoreBounds(i);
+		}
+	} catch (IloException& e) {
+		cerr << "Concert exception caught: " << e << endl;
+	} catch (...) {
+		cerr << "Unknown exception caught" << endl;
+	}
+}
+
+// Create model i from a block of the binary model
+void CPLEX::LoadBlock(const int i, const LPBlock& block) {
+	LoadBlock(i, block, block);
+}
+
+// Same as above, but the rows senses and the matrix structure are taken from 'structure'
+void CPLEX::LoadBlock(const int i, const LPBlock& block, const LPBlock& structure) {
+	int nrows = structure.sense.size(), ncols = block.obj.size();
+	
+	// Variables with their bounds
+	IloNumArray lower(SubEnv[i], ncols), upper(SubEnv[i], ncols), coefs(SubEnv[i], ncols);
+	for (int j=0; j < ncols; ++j) {
+		lower[j] = (block.lb[j] <= -MPS_INF) ? -IloInfinity : block.lb[j];
+		upper[j] = (block.ub[j] >= MPS_INF) ? IloInfinity : block.ub[j];
+		coefs[j] = block.obj[j];
+	}
+	var[i] = IloNumVarArray(SubEnv[i], lower, upper);
+	
+	// Constraints as ranges, depending on the sense of the row
+	IloNumArray rowlower(SubEnv[i], nrows), rowupper(SubEnv[i], nrows);
+	for (int k=0; k < nrows; ++k) {
+		rowlower[k] = (structure.sense[k] == 'L') ? -IloInfinity : block.rhs[k];
+		rowupper[k] = (structure.sense[k] == 'G') ? IloInfinity : block.rhs[k];
+	}
+	rng[i] = IloRangeArray(SubEnv[i], rowlower, rowupper);
+	
+	// Objective function
+	obj[i] = IloMinimize(SubEnv[i]);
+	obj[i].setLinearCoefs(var[i], coefs);
+	
+	// Transpose the matrix to fill the constraints one row at a time
+	vector<int> rowstart(nrows+1, 0), position;
+	for (unsigned int n=0; n < structure.rowindex.size(); ++n)
+		++rowstart[structure.rowindex[n]+1];
+	for (int k=0; k < nrows; ++k)
+		rowstart[k+1] += rowstart[k];
+	position = rowstart;
+	
+	vector<int> colindex(block.value.size());
+	vector<double> rowvalue(block.value.size());
+	for (int j=0; j < ncols; ++j) {
+		for (int n=structure.colstart[j]; n < structure.colstart[j+1]; ++n) {
+			int k = structure.rowindex[n];
+			colindex[position[k]] = j;
+			rowvalue[position[k]] = block.value[n];
+			++position[k];
+		}
+	}
+	
+	for (int k=0; k < nrows; ++k) {
+		int size = rowstart[k+1] - rowstart[k];
+		IloNumVarArray rowvars(SubEnv[i], size);
+		IloNumArray rowcoefs(SubEnv[i], size);
+		for (int n=0; n < size; ++n) {
+			rowvars[n] = var[i][colindex[rowstart[k] + n]];
+			rowcoefs[n] = rowvalue[rowstart[k] + n];
+		}
+		rng[i][k].setLinearCoefs(rowvars, rowcoefs);
+		rowvars.end(); rowcoefs.end();
+	}
+	
+	model[i].add(obj[i]);
+	model[i].add(var[i]);
+	model[i].add(rng[i]);
+	
+	lower.end(); upper.end(); coefs.end(); rowlower.end(); rowupper.end();
+}
+
+// Changes the problems loaded from 'current' to the values in 'blocks', so that the next solve starts
+// from the previous basis. Returns false (and changes nothing) if the structure of a block is different
+bool CPLEX::UpdateProblem(const vector<LPBlock>& current, const vector<LPBlock>& blocks) {
+	int nyears = ctx.SLength[0];
+	if (current.size() != blocks.size())
+		return false;
+	for (unsigned int b = 0; b < blocks.size(); ++b) {
+		const LPBlock& before = (current[b].templ >= 0) ? current[current[b].templ] : current[b];
+		const LPBlock& after = (blocks[b].templ >= 0) ? blocks[blocks[b].templ] : blocks[b];
+		if (!before.SameStructure(after))
+			return false;
+	}
+
+	try {
+		bool subproblems = false;
+		for (int i=0; i <= nyears; ++i) {
+			int b = (!ctx.useBenders && (i == 0)) ? 0 : i+1;
+			const LPBlock& structure = (blocks[b].templ >= 0) ? blocks[blocks[b].templ] : blocks[b];
+			int changes = UpdateBlock(i, current[b], blocks[b], structure);
+			if (ctx.outputLevel < 2) cout << "  Problem " << i << ": " << changes << " changes" << endl;
+			if ((i > 0) && (changes > 0)) subproblems = true;
+		}
+
+		// Cuts are built with the duals of the subproblems, so they are not valid if those change
+		if (ctx.useBenders && subproblems)
+			ClearCuts();
+		if (subproblems)
+			ScreenYear.clear();
+	} catch (IloException& e) {
+		cerr << "Concert exception caught: " << e << endl;
+	} catch (...) {
+		cerr << "Unknown exception caught" << endl;
+	}
+	return true;
+}
+
+// Applies the coefficients, right hand sides and bounds of 'block' that differ from 'current' to model i
+int CPLEX::UpdateBlock(const int i, const LPBlock& current, const LPBlock& block, const LPBlock& structure) {
+	int nrows = structure.sense.size(), ncols = block.obj.size(), changes = 0;
+
+	for (int j=0; j < ncols; ++j) {
+		if ((block.lb[j] != current.lb[j]) || (block.ub[j] != current.ub[j])) {
+			VarLB[i][j] = (block.lb[j] <= -MPS_INF) ? -IloInfinity : block.lb[j];
+			VarUB[i][j] = (block.ub[j] >= MPS_INF) ? IloInfinity : block.ub[j];
+			var[i][j].setBounds(VarLB[i][j], VarUB[i][j]);
+			++changes;
+		}
+		if (block.obj[j] != current.obj[j]) {
+			obj[i].setLinearCoef(var[i][j], block.obj[j]);
+			++changes;
+		}
+		for (int n=structure.colstart[j]; n < structure.colstart[j+1]; ++n) {
+			if (block.value[n] != current.value[n]) {
+				rng[i][structure.rowindex[n]].setLinearCoef(var[i][j], block.value[n]);
+				++changes;
+			}
+		}
+	}
+
+	for (int k=0; k < nrows; ++k) {
+		if (block.rhs[k] != current.rhs[k]) {
+			rng[i][k].setBounds((structure.sense[k] == 'L') ? -IloInfinity : block.rhs[k],
+			                    (structure.sense[k] == 'G') ? IloInfinity : block.rhs[k]);
+			++changes;
+		}
+	}
+	return changes;
+}
+
+// Runs a task for several years, with up to 'BendersThreads' threads. Each task only uses the
+// objects of its own subproblem, which have their own environment when threads are used
+void CPLEX::RunParallel(const vector<int>& years, int (CPLEX::*task)(const int), vector<int>& result) {
+	result.assign(years.size(), 0);
+	int nthreads = min(ctx.BendersThreads, (int) years.size());
+	if (nthreads <= 1) {
+		for (unsigned int n = 0; n < years.size(); ++n)
+			result[n] = (this->*task)(years[n]);
+		return;
+	}
+	
+	SubproblemWork work;
+	work.problem = this; work.task = task; work.years = &years; work.result = &result; work.next = 0;
+	pthread_mutex_init(&work.lock, NULL);
+	vector<pthread_t> threads(nthreads);
+	for (int t = 0; t < nthreads; ++t)
+		pthread_create(&threads[t], NULL, SubproblemWorker, &work);
+	for (int t = 0; t < nthreads; ++t)
+		pthread_join(threads[t], NULL);
+	pthread_mutex_destroy(&work.lock);
+}
+
+// Solves Benders subproblem j with the capacities of the master problem. If a cut is needed,
+// the duals of the rows and the reduced costs of the columns are stored in DualArray[j]
+// and TempNumArray[j]. Returns 0 if no cut is needed, 1 for feasibility and 2 for optimality cuts
+int CPLEX::BendersTask(const int j) {
+	int cut = 0;
+	try {
+		cplex[j].solve();
+		SimplexIter[j] += cplex[j].getNiterations();
+		
+		if (cplex[j].getCplexStatus() != CPX_STAT_OPTIMAL) {
+			// Change solver properties to find dual unbouded ray
+			cut = 1;
+			cplex[j].setParam(IloCplex::PreInd,0);
+			cplex[j].setParam(IloCplex::ScaInd,-1);
+			cplex[j].setParam(IloCplex::RootAlg, IloCplex::Primal);
+			cplex[j].solve();
+			SimplexIter[j] += cplex[j].getNiterations();
+		} else {
+			SubObj[j] = cplex[j].getObjValue();
+			if (AlwaysCut || (solution[j-1] <= SubObj[j] * 0.999))
+				cut = 2;
+		}
+		
+		if (cut > 0) {
+			cplex[j].getDuals(DualArray[j], rng[j]);
+			cplex[j].getReducedCosts(TempNumArray[j], var[j]);
+		}
+	} catch (IloException& e) {
+		cerr << "Concert exception caught: " << e << endl;
+		cut = -1;
+	} catch (...) {
+		cerr << "Unknown exception caught" << endl;
+		cut = -1;
+	}
+	return cut;
+}
+
+// Simplex iterations of all the problems since the last call
+long CPLEX::Iterations() {
+	long total = 0;
+	for (unsigned int i = 0; i < SimplexIter.size(); ++i) {
+		total += SimplexIter[i];
+		SimplexIter[i] = 0;
+	}
+	return total;
+}
+
+// Rows of problem i for its basis. The master also has the rows of the Benders cuts, after its own
+// rows; the array must be ended by the caller in that case
+IloRangeArray CPLEX::BasisRows(const int i) {
+	if ((i > 0) || (MasterCuts.getSize() == 0))
+		return rng[i];
+	IloRangeArray rows(SubEnv[0]);
+	for (int k=0; k < rng[0].getSize(); ++k)
+		rows.add(rng[0][k]);
+	for (int k=0; k < MasterCuts.getSize(); ++k)
+		rows.add(MasterCuts[k]);
+	return rows;
+}
+
+// Identifies the cuts in the master. Cuts out of the pool have no key, so they only match if
+// there are none
+vector<string> CPLEX::BasisCuts() {
+	if (ctx.useCutPool)
+		return CutKey;
+	return vector<string>(MasterCuts.getSize(), "");
+}
+
+// Stores the basis of the master and subproblems (or of the single problem). Problems without a
+// basis (e.g., infeasible) are left empty
+void CPLEX::GetBasis(Basis& basis) {
+	basis.cols.assign(cplex.getSize(), vector<int>());
+	basis.rows.assign(cplex.getSize(), vector<int>());
+	basis.cuts = BasisCuts();
+	for (int i=0; i < cplex.getSize(); ++i) {
+		IloRangeArray rows = BasisRows(i);
+		try {
+			IloCplex::BasisStatusArray cstat(SubEnv[i]), rstat(SubEnv[i]);
+			cplex[i].getBasisStatuses(cstat, var[i], rstat, rows);
+			for (int k=0; k < cstat.getSize(); ++k)
+				basis.cols[i].push_back(cstat[k]);
+			for (int k=0; k < rstat.getSize(); ++k)
+				basis.rows[i].push_back(rstat[k]);
+			cstat.end(); rstat.end();
+		} catch (IloException& e) {
+			basis.cols[i].clear();
+			basis.rows[i].clear();
+		}
+		if ((i == 0) && (MasterCuts.getSize() > 0))
+			rows.end();
+	}
+}
+
+// Starts the next solution of each problem from a stored basis. The master is skipped if its cuts
+// are not the ones of the basis
+void CPLEX::SetBasis(const Basis& basis) {
+	bool sameCuts = (basis.cuts == BasisCuts());
+	for (int i=0; (i < cplex.getSize()) && (i < basis.cols.size()); ++i) {
+		if ((i == 0) && !sameCuts)
+			continue;
+		IloRangeArray rows = BasisRows(i);
+		if ((basis.cols[i].size() == var[i].getSize()) && (basis.rows[i].size() == rows.getSize())) {
+			try {
+				IloCplex::BasisStatusArray cstat(SubEnv[i], var[i].getSize()), rstat(SubEnv[i], rows.getSize());
+				for (int k=0; k < var[i].getSize(); ++k)
+					cstat[k] = (IloCplex::BasisStatus) basis.cols[i][k];
+				for (int k=0; k < rows.getSize(); ++k)
+					rstat[k] = (IloCplex::BasisStatus) basis.rows[i][k];
+				cplex[i].setBasisStatuses(cstat, var[i], rstat, rows);
+				cstat.end(); rstat.end();
+			} catch (IloException& e) {
+				cerr << "Concert exception caught: " << e << endl;
+			}
+		}
+		if ((i == 0) && (MasterCuts.getSize() > 0))
+			rows.end();
+	}
+}
+
+// Checks if an individual whose objectives are at least 'bound' is dominated by a point of PruneFront
+bool CPLEX::Dominated(const vector<double>& bound) {
+	for (unsigned int p = 0; p < PruneFront.size(); ++p) {
+		const vector<double>& point = PruneFront[p];
+		bool dominated = true, strict = false;
+		for (int k=0; k < ctx.Nobj; ++k) {
+			if (point[k] > bound[k]) dominated = false;
+			if (point[k] < bound[k]) strict = true;
+		}
+		if (dominated && strict)
+			return true;
+	}
+	return false;
+}
+
+// Checks if the individual is dominated with the cost of the events solved so far (the cost
+// of the remaining events is at least 0). In that case, the resiliency gets that bound
+bool CPLEX::DominatedResiliency(double *objective, const double cost, const bool feasible) {
+	int k = ctx.SustObj.size() + 1;
+	vector<double> bound(objective, objective + ctx.Nobj);
+	bound[k] = cost / ctx.Nevents;
+	if (!feasible)
+		bound[k] = 1.0e9;
+	if (!Dominated(bound))
+		return false;
+	objective[k] = bound[k];
+	return true;
+}
+
+// Solves the base case and all the events that affect year j in subproblem j. The cost and the
+// nodal duals are stored in EventCost and EventDuals (event 0 is the base case). As in the serial
+// evaluation, the events that are not screened are solved by decreasing estimated impact
+int CPLEX::ResiliencyTask(const int j) {
+	const EventStore& events = *TaskEvents;
+	try {
+		// The subproblem is already solved with Benders
+		if (!ctx.useBenders)
+			cplex[j].solve();
+		EventCost[0][j] = cplex[j].getObjValue();
+		if (ctx.useScreening)
+			ScreenBase(j);
+		
+		int nodes = 0;
+		for (int n = 0; n < ctx.IdxNode.size; ++n)
+			if (ctx.IdxNode.year[n] == j) ++nodes;
+		
+		vector< pair<double, int> > order;
+		for (int event=1; event <= ctx.Nevents; ++event) {
+			if (!events.Affects(event, j))
+				continue;
+			
+			// The base solution is still optimal, the duals are the ones of the base case
+			double impact = 0;
+			if (ctx.useScreening && NonBinding(events, event, j, impact)) {
+				EventCost[event][j] = EventCost[0][j];
+				continue;
+			}
+			order.push_back(make_pair(-impact, event));
+		}
+		if (ctx.useScreening)
+			sort(order.begin(), order.end());
+		
+		for (unsigned int e = 0; e < order.size(); ++e) {
+			int event = order[e].second;
+			
+			// Reduce the capacities of this year affected by the event
+			vector<int> cols;
+			vector<double> reduced, base;
+			for (int k = events.start[event]; k < events.start[event+1]; ++k) {
+				if (events.year[k] == j) {
+					cols.push_back(CapPos[events.cap[k]]);
+					reduced.push_back(events.factor[k] * solution[events.cap[k]]);
+					base.push_back(solution[events.cap[k]]);
+				}
+			}
+			ApplyUpper(j, cols, reduced);
+			
+			cplex[j].solve();
+			if (cplex[j].getCplexStatus() == CPX_STAT_OPTIMAL) {
+				EventCost[event][j] = cplex[j].getObjValue();
+				cplex[j].getDuals(DualArray[j], rng[j]);
+				EventDuals[event][j].resize(nodes);
+				for (int n = 0; n < nodes; ++n)
+					EventDuals[event][j][n] = DualArray[j][ctx.SustMet.size() + n];
+			}
+			
+			// Restore the capacities for the next event
+			ApplyUpper(j, cols, base);
+		}
+	} catch (IloException& e) {
+		cerr << "Concert exception caught: " << e << endl;
+	} catch (...) {
+		cerr << "Unknown exception caught" << endl;
+	}
+	return 0;
+}
+
+// Solves the resiliency events with several threads (one year each) and combines the costs and
+// duals in the same order as when they are solved one after the other
+void CPLEX::SolveEventsParallel(const EventStore& events, double *ResilObj, bool& ResilOptimal) {
+	int nyears = ctx.SLength[0];
+	EventCost.assign(ctx.Nevents + 1, vector<double>(nyears + 1, 1.0e30));
+	EventDuals.assign(ctx.Nevents + 1, vector< vector<double> >(nyears + 1));
+	
+	vector<int> years, result;
+	for (int j=1; j <= nyears; ++j)
+		if (events.Affects(0, j)) years.push_back(j);
+	TaskEvents = &events;
+	RunParallel(years, &CPLEX::ResiliencyTask, result);
+	TaskEvents = NULL;
+	
+	// Operational cost of the base case
+	for (int j=1; j <= nyears; ++j) {
+		if (events.Affects(0, j)) {
+			for (int event=1; event <= ctx.Nevents; ++event)
+				if (events.Affects(event, j))
+					ResilObj[event-1] -= EventCost[0][j];
+		}
+	}
+	
+	try {
+		for (int event=1; event <= ctx.Nevents; ++event) {
+			bool current_feasible = true;
+			for (int j=1; (j <= nyears) && current_feasible; ++j) {
+				if (!events.Affects(event, j))
+					continue;
+				if (EventCost[event][j] >= 1.0e29) {
+					// If subproblem is infeasible
+					ResilObj[event-1] = 1.0e10;
+					ResilOptimal = false;
+					current_feasible = false;
+					if (ctx.outputLevel < 2) cout << "\t\tEv: " << event << "\tYr: " << j << "\tInfeasible!" << endl;
+				} else {
+					ResilObj[event-1] += EventCost[event][j];
+					if (EventDuals[event][j].empty()) ++Screened;
+				}
+			}
+			
+			// Nodal duals, the years not affected by the event (or screened) keep the ones of the base case
+			if (current_feasible) {
+				vector<int> position(nyears + 1, 0);
+				for (int n = 0; n < ctx.IdxNode.size; ++n) {
+					int year = ctx.IdxNode.year[n];
+					if (events.Affects(event, year) && !EventDuals[event][year].empty())
+						dualsolution[event].add(EventDuals[event][year][position[year]]);
+					else
+						dualsolution[event].add(dualsolution[0][n]);
+					++position[year];
+				}
+			}
+		}
+	} catch (IloException& e) {
+		cerr << "Concert exception caught: " << e << endl;
+	} catch (...) {
+		cerr << "Unknown exception caught" << endl;
+	}
+}
+
+// Sizes the screening information for the loaded problems (the rows are found again if they changed)
+void CPLEX::ScreenPrepare() {
+	int nyears = ctx.SLength[0];
+	if (ScreenYear.size() != nyears + 1) {
+		ScreenYear.assign(nyears + 1, 0);
+		ScreenRows.assign(ctx.IdxCap.size, vector<int>());
+		ScreenCoef.assign(ctx.IdxCap.size, vector<double>());
+		ScreenCap.assign(ctx.IdxCap.size, 0);
+		BaseCap.assign(ctx.IdxCap.size, 0);
+		BaseSlack.assign(nyears + 1, vector<double>());
+		BaseRowDual.assign(nyears + 1, vector<double>());
+	}
+}
+
+// Finds the rows of subproblem j that include each capacity of year j. A capacity can only be
+// screened if it has no cost and all its rows are upper bounds where it has a negative coefficient
+// (as in 'flow - hours * capacity <= 0'), so that a lower capacity only reduces the slack of the rows
+void CPLEX::ScreenStructure(const int j) {
+	map<long, int> capacity;
+	for (int i=0; i < ctx.IdxCap.size; ++i) {
+		if (ctx.IdxCap.year[i] == j) {
+			capacity[var[j][CapPos[i]].getId()] = i;
+			ScreenRows[i].clear();
+			ScreenCoef[i].clear();
+			ScreenCap[i] = 1;
+		}
+	}
+	
+	IloExpr cost = obj[j].getExpr();
+	for (IloExpr::LinearIterator it = cost.getLinearIterator(); it.ok(); ++it) {
+		map<long, int>::iterator found = capacity.find(it.getVar().getId());
+		if ((found != capacity.end()) && (it.getCoef() != 0))
+			ScreenCap[found->second] = 0;
+	}
+	
+	for (int r=0; r < rng[j].getSize(); ++r) {
+		bool upper = (rng[j][r].getLB() <= -IloInfinity) && (rng[j][r].getUB() < IloInfinity);
+		IloExpr row = rng[j][r].getExpr();
+		for (IloExpr::LinearIterator it = row.getLinearIterator(); it.ok(); ++it) {
+			map<long, int>::iterator found = capacity.find(it.getVar().getId());
+			if (found == capacity.end())
+				continue;
+			int i = found->second;
+			ScreenRows[i].push_back(r);
+			ScreenCoef[i].push_back(it.getCoef());
+			if (!upper || (it.getCoef() > 0))
+				ScreenCap[i] = 0;
+		}
+	}
+	ScreenYear[j] = 1;
+}
+
+// Stores the capacities, row slacks and row duals of the base case of subproblem j
+void CPLEX::ScreenBase(const int j) {
+	if (!ScreenYear[j])
+		ScreenStructure(j);
+	
+	for (int i=0; i < ctx.IdxCap.size; ++i)
+		if (ctx.IdxCap.year[i] == j)
+			BaseCap[i] = cplex[j].getValue(var[j][CapPos[i]]);
+	
+	IloNumArray values(SubEnv[j], rng[j].getSize());
+	cplex[j].getSlacks(values, rng[j]);
+	BaseSlack[j].assign(values.getSize(), 0);
+	for (int r=0; r < values.getSize(); ++r)
+		BaseSlack[j][r] = values[r];
+	cplex[j].getDuals(values, rng[j]);
+	BaseRowDual[j].assign(values.getSize(), 0);
+	for (int r=0; r < values.getSize(); ++r)
+		BaseRowDual[j][r] = values[r];
+	values.end();
+}
+
+// An event cannot change the cost of year j if the base solution, with the capacities reduced to the
+// values of the event, is still feasible: all the rows of the reduced capacities have enough slack
+bool CPLEX::NonBinding(const EventStore& events, const int event, const int j, double& impact) {
+	map<int, double> used;
+	bool screened = true;
+	impact = 0;
+	
+	for (int k = events.start[event]; k < events.start[event+1]; ++k) {
+		if (events.year[k] != j)
+			continue;
+		int i = events.cap[k];
+		double delta = BaseCap[i] - events.factor[k] * solution[i];
+		if (delta <= 0)
+			continue;
+		if (!ScreenCap[i] || (events.factor[k] * solution[i] < VarLB[j][CapPos[i]]))
+			screened = false;
+		for (unsigned int r = 0; r < ScreenRows[i].size(); ++r) {
+			used[ScreenRows[i][r]] -= ScreenCoef[i][r] * delta;
+			impact += fabs(BaseRowDual[j][ScreenRows[i][r]] * ScreenCoef[i][r]) * delta;
+		}
+	}
+	
+	for (map<int, double>::iterator it = used.begin(); it != used.end(); ++it)
+		if (BaseSlack[j][it->first] < it->second * (1 + 1.0e-9) + 1.0e-9)
+			screened = false;
+	
+	return screened;
+}
+
+// Removes the Benders cuts added to the master problem
+void CPLEX::ClearCuts() {
+	if (MasterCuts.getSize() > 0) {
+		model[0].remove(MasterCuts);
+		MasterCuts.endElements();
+		MasterCuts.clear();
+	}
+	CutKey.clear();
+	CutAge.clear();
+}
+
+// Key of the cut of subproblem j (type 1 feasibility, 2 optimality) with its year and coefficients
+// rounded to 8 digits. Feasibility cuts come from a ray, so they are scaled by their largest value
+string CPLEX::CutSignature(const int j, const int type, const double constant) {
+	vector<double> coef(1, constant);
+	for (int i=0; i < ctx.IdxCap.size; ++i)
+		if (ctx.IdxCap.year[i] == j)
+			coef.push_back(TempNumArray[j][CapPos[i]]);
+	
+	double scale = 0;
+	for (unsigned int k = 0; k < coef.size(); ++k)
+		scale = max(scale, fabs(coef[k]));
+	
+	ostringstream key;
+	key << j << ":" << type << setprecision(8);
+	for (unsigned int k = 0; k < coef.size(); ++k) {
+		double value = coef[k];
+		if (type == 1 && scale > 0) value /= scale;
+		if (fabs(value) < 1e-12 * max(scale, 1.0)) value = 0;
+		key << "," << value;
+	}
+	return key.str();
+}
+
+// Scale of each capacity for the trust region and the level method: its value in the center, or the
+// average capacity if it is smaller (so that capacities that are zero can also change)
+vector<double> CapacityScale(const vector<double>& center) {
+	double average = 0;
+	for (unsigned int i = 0; i < center.size(); ++i)
+		average += fabs(center[i]);
+	if (center.size() > 0)
+		average /= center.size();
+	if (average <= 0)
+		average = 1;
+	
+	vector<double> scale(center.size());
+	for (unsigned int i = 0; i < center.size(); ++i)
+		scale[i] = max(fabs(center[i]), average);
+	return scale;
+}
+
+// Solves the master problem with the capacities limited to a box around 'center' (radius relative
+// to the scale of each capacity). 'binding' tells if the box limits the solution. The original
+// bounds are restored afterwards
+bool CPLEX::SolveTrustRegion(const vector<double>& center, const double radius, bool& binding) {
+	int nyears = ctx.SLength[0];
+	bool solved = false;
+	binding = false;
+	
+	try {
+		vector<double> scale = CapacityScale(center);
+		vector<double> lb(center.size()), ub(center.size()), boxlb(center.size()), boxub(center.size());
+		vector<int> cols(center.size());
+		for (unsigned int i = 0; i < center.size(); ++i) {
+			cols[i] = nyears + i;
+			lb[i] = VarLB[0][nyears + i];
+			ub[i] = VarUB[0][nyears + i];
+			boxlb[i] = max(lb[i], center[i] - radius * scale[i]);
+			boxub[i] = min(ub[i], center[i] + radius * scale[i]);
+		}
+		ApplyBounds(0, cols, boxlb, boxub);
+		
+		solved = cplex[0].solve();
+		SimplexIter[0] += cplex[0].getNiterations();
+		if (solved) {
+			StoreSolution(true);
+			for (unsigned int i = 0; i < center.size(); ++i) {
+				double tolerance = 1.0e-6 * scale[i];
+				if (((boxlb[i] > lb[i]) && (solution[nyears + i] <= boxlb[i] + tolerance)) ||
+					((boxub[i] < ub[i]) && (solution[nyears + i] >= boxub[i] - tolerance)))
+					binding = true;
+			}
 		}
+		
+		ApplyBounds(0, cols, lb, ub);
+	} catch (IloException& e) {
+		cerr << "Concert exception caught: " << e << endl;
+	} catch (...) {
+		cerr << "Unknown exception caught" << endl;
+	}
+	return solved;
+}
+
+// Level method: solves the capacities closest to 'center' (infinity norm with the same scale as the
+// trust region) whose cost in the master is below 'level'. 'cost' is the objective of the master
+// at that point. The objective and the constraints of the master are restored afterwards
+bool CPLEX::SolveLevel(const vector<double>& center, const double level, double& cost) {
+	int nyears = ctx.SLength[0];
+	bool solved = false;
+	
+	try {
+		vector<double> scale = CapacityScale(center);
+		IloExpr CostExpr(obj[0].getExpr());
+		IloNumVar dist(env, 0, IloInfinity);
+		IloRangeArray projection(env, 0);
+		projection.add(CostExpr <= level);
+		for (unsigned int i = 0; i < center.size(); ++i) {
+			projection.add(var[0][nyears + i] - scale[i] * dist <= center[i]);
+			projection.add(var[0][nyears + i] + scale[i] * dist >= center[i]);
+		}
+		model[0].add(projection);
+		obj[0].setExpr(dist);
+		
+		solved = cplex[0].solve();
+		SimplexIter[0] += cplex[0].getNiterations();
+		if (solved) {
+			StoreSolution(true);
+			cost = cplex[0].getValue(CostExpr);
+		}
+		
+		obj[0].setExpr(CostExpr);
+		model[0].remove(projection);
+		projection.endElements();
+		projection.end();
+		dist.end();
+		CostExpr.end();
+	} catch (IloException& e) {
+		cerr << "Concert exception caught: " << e << endl;
+	} catch (...) {
+		cerr << "Unknown exception caught" << endl;
+	}
+	return solved;
+}
+
+// Updates the age of the cuts in the pool after an individual and removes the old ones. Cuts that
+// are binding in the last master solution (slack within CutSlack of the cost) become new again
+void CPLEX::PurgeCuts(const bool optimal) {
+	try {
+		IloNumArray slacks(env, 0);
+		double tolerance = 0;
+		if (optimal && (MasterCuts.getSize() > 0)) {
+			cplex[0].getSlacks(slacks, MasterCuts);
+			tolerance = ctx.CutSlack * max(1.0, fabs(cplex[0].getObjValue()));
+		}
+		
+		IloRangeArray kept(env, 0), removed(env, 0);
+		vector<string> keptKey;
+		for (int i=0; i < MasterCuts.getSize(); ++i) {
+			int& age = CutAge[CutKey[i]];
+			if (optimal && (fabs(slacks[i]) <= tolerance))
+				age = 0;
+			else
+				++age;
+			
+			if (age > ctx.CutMaxAge) {
+				removed.add(MasterCuts[i]);
+				CutAge.erase(CutKey[i]);
+			} else {
+				kept.add(MasterCuts[i]);
+				keptKey.push_back(CutKey[i]);
+			}
+		}
+		
+		if (removed.getSize() > 0)
+			model[0].remove(removed);
+		removed.endElements();
+		removed.end();
+		slacks.end();
+		MasterCuts.end();
+		MasterCuts = kept;
+		CutKey.swap(keptKey);
+		
+		if (ctx.outputLevel < 2)
+			cout << "\tCuts in pool: " << MasterCuts.getSize() << endl;
 	} catch (IloException& e) {
 		cerr << "Concert exception caught: " << e << endl;
 	} catch (...) {
@@ -65,19 +846,22 @@ void CPLEX::LoadProblem() {
 }
 
 // Solves current model
-void CPLEX::SolveIndividual(double *objective, const double events[], const bool saveDual, string *returnString) {
-	int nyears = SLength[0];
+void CPLEX::SolveIndividual(double *objective, const EventStore& events, const bool saveDual, string *returnString) {
+	int nyears = ctx.SLength[0];
 	
 	try {
 		// Keep track of solution
 		bool optimal = true;
 		int iter = 0;
+		Pruned = false;
+		BaseBasis = Basis();
 		
-		if (!useBenders) {
+		if (!ctx.useBenders) {
 			// Only one file
-			if (outputLevel < 2) cout << "- Solving problem" << endl;
+			if (ctx.outputLevel < 2) cout << "- Solving problem" << endl;
 			
 			if (cplex[0].solve()) {
+				SimplexIter[0] += cplex[0].getNiterations();
 				optimal = true;
 				objective[0] = cplex[0].getObjValue();
 				
@@ -90,8 +874,24 @@ void CPLEX::SolveIndividual(double *objective, const double events[], const bool
 		} else {
 			// Use Benders decomposition
 			int OptCuts = 1, FeasCuts = 1;
+			bool repeated = false, converged = false;
+			
+			// Stabilisation (BendersMethod): 1 in-out, 2 trust region, 3 level. The stabilised steps solve
+			// the subproblems at another point than the master solution; the last iterations are always
+			// plain cutting planes (Kelley), which decide when the solution is optimal
+			int method = 0;
+			if (ctx.BendersMethod == "inout") method = 1;
+			else if (ctx.BendersMethod == "trust") method = 2;
+			else if (ctx.BendersMethod == "level") method = 3;
+			bool stabilise = (method > 0);
+			double lower = -1.0e30, upper = 1.0e30, radius = ctx.TrustRadius;
+			int StabSteps = 0;
+			
+			// Capacities of the master solution and of the stability center (core point or incumbent)
+			vector<double> current(ctx.IdxCap.size), center;
+			Convergence.clear();
 			
-			while ((OptCuts+FeasCuts > 0) && (iter <= MAX_ITER)) {
+			while (!converged && (iter <= MAX_ITER) && !repeated) {
 				++iter; OptCuts = 0; FeasCuts = 0;
 				
 				// Keep track of necessary cuts
@@ -102,63 +902,178 @@ void CPLEX::SolveIndividual(double *objective, const double events[], const bool
 				// cplex[0].exportModel("master.lp");
 				
 				// Solve master problem. If master is infeasible, exit loop
-				if (outputLevel < 2) cout << "- Solving master problem (Iteration #" << iter << ")" << endl;
-				if (!cplex[0].solve()) {
+				if (ctx.outputLevel < 2) cout << "- Solving master problem (Iteration #" << iter << ")" << endl;
+				bool solved = cplex[0].solve();
+				SimplexIter[0] += cplex[0].getNiterations();
+				if (!solved) {
 					break;
 				}
 				
 				// Recover variables (first nyears are estimated obj. val)
 				StoreSolution(true);
+				lower = cplex[0].getObjValue();
+				double cost = lower;
+				
+				// Stop if the lower bound of the cost is dominated. The other objectives have no bound
+				// yet (e.g., emissions can be negative), so only with the cost as the single objective
+				if (!PruneFront.empty() && (ctx.Nobj == 1)) {
+					vector<double> bound(1, lower);
+					if (Dominated(bound)) {
+						objective[0] = lower;
+						Pruned = true;
+						break;
+					}
+				}
+				
+				// Stop stabilising when the bounds are close enough (trust region and level)
+				if (stabilise && (method > 1) && (upper < 1.0e29) && (upper - lower <= ctx.StabGap * fabs(upper)))
+					stabilise = false;
+				
+				// Stabilised step, which needs a center (the incumbent for trust region and level)
+				bool StabStep = stabilise && !center.empty(), binding = false;
+				if (StabStep && (method == 2)) {
+					// Master restricted to a box around the incumbent
+					if (!SolveTrustRegion(center, radius, binding)) {
+						cplex[0].solve();
+						StabStep = stabilise = false;
+					} else {
+						cost = cplex[0].getObjValue();
+					}
+				} else if (StabStep && (method == 3)) {
+					// Closest point to the incumbent whose cost in the master is below the level
+					if (!SolveLevel(center, lower + ctx.StabFactor * (upper - lower), cost)) {
+						cplex[0].solve();
+						StabStep = stabilise = false;
+					}
+				}
+				if (StabStep) ++StabSteps;
+				
+				// First stage cost of the master solution, without the estimated cost of the subproblems
+				for (int j=1; j <= nyears; ++j)
+					cost -= solution[j-1];
+				for (int i=0; i < ctx.IdxCap.size; ++i)
+					current[i] = solution[nyears + i];
+				
+				// In-out: the subproblems are solved between the master solution and the core point
+				if (stabilise && (method == 1)) {
+					if (center.empty())
+						center = current;
+					for (int i=0; i < ctx.IdxCap.size; ++i)
+						solution[nyears + i] = ctx.StabFactor * current[i] + (1 - ctx.StabFactor) * center[i];
+				}
 				
 				// Store capacities as constraints
 				CapacityConstraints(events, 0, nyears);
 				
 				// Start subproblems
-				if (outputLevel < 2) cout << "- Solving subproblems" << endl << "  ";
+				if (ctx.outputLevel < 2) cout << "- Solving subproblems" << endl << "  ";
 				
+				// Solve subproblems (in parallel if several threads are used), then
+				// build the cuts in order of the years so that the result is the same
+				vector<int> years(nyears), cuts;
+				for (int j=1; j <= nyears; ++j) years[j-1] = j;
+				SubObj.assign(nyears + 1, 1.0e30);
+				AlwaysCut = StabStep && (method == 1);
+				RunParallel(years, &CPLEX::BendersTask, cuts);
+				AlwaysCut = false;
+				
+				// A subproblem that could not be solved gives no cut or bound, so the solution is not optimal
+				int Failed = count(cuts.begin(), cuts.end(), -1);
+				if (Failed > 0) {
+					cout << "\tERROR: " << Failed << " subproblems could not be solved" << endl;
+					for (int j=1; j <= nyears; ++j) {
+						cplex[j].setParam(IloCplex::PreInd,1);
+						cplex[j].setParam(IloCplex::ScaInd,0);
+						cplex[j].setParam(IloCplex::RootAlg, IloCplex::Dual);
+					}
+					break;
+				}
+				
+				vector<string> keys(nyears);
+				int RepCuts = 0, Violated = 0;
 				for (int j=1; j <= nyears; ++j) {
-					// Solve subproblem
-					cplex[j].solve();
-					
-					if (cplex[j].getCplexStatus() != CPX_STAT_OPTIMAL) {
-						// If subproblem is infeasible, create feasibility cut
-						++FeasCuts; status[j-1] = true;
+					status[j-1] = (cuts[j-1] > 0);
+					double constant = 0;
+					if (status[j-1]) {
+						for (int k=0; k < DualArray[j].getSize(); ++k)
+							constant += DualArray[j][k] * rng[j][k].getUB();
 						
-						// Change solver properties to find dual unbouded ray
-						cplex[j].setParam(IloCplex::PreInd,0);
-						cplex[j].setParam(IloCplex::ScaInd,-1);
-						cplex[j].setParam(IloCplex::RootAlg, IloCplex::Primal);
-						cplex[j].solve();
+						// In-out: check if the cut also removes the master solution
+						if (StabStep && (method == 1)) {
+							double value = constant;
+							for (int i=0; i < ctx.IdxCap.size; ++i)
+								if (ctx.IdxCap.year[i] == j)
+									value += TempNumArray[j][CapPos[i]] * current[i];
+							if ((cuts[j-1] == 1) ? (value > 1.0e-6 * max(1.0, fabs(constant))) : (solution[j-1] <= value * 0.999))
+								++Violated;
+						}
 						
+						// A cut that is already in the pool is not added again (it only becomes new)
+						if (ctx.useCutPool) {
+							keys[j-1] = CutSignature(j, cuts[j-1], constant);
+							if (CutAge.count(keys[j-1]) > 0) {
+								CutAge[keys[j-1]] = 0;
+								status[j-1] = false;
+								if (cuts[j-1] == 1) ++RepCuts;
+								if (ctx.outputLevel < 2) cout << "=" << j << " ";
+							}
+						}
+					}
+					
+					if (!status[j-1]) {
+						// No cut
+					} else if (cuts[j-1] == 1) {
+						// If subproblem is infeasible, create feasibility cut
+						++FeasCuts;
 						IloExpr temp(env); expr_cut[j-1] = temp;
-						cplex[j].getDuals(TempArray, rng[j]);
-						for (int k=0; k < TempArray.getSize(); ++k)
-							expr_cut[j-1] += TempArray[k] * rng[j][k].getUB();
-						cplex[j].getReducedCosts(TempNumArray[j-1], var[j]);
-						
-						if (outputLevel < 2) cout << j << " ";
-					} else if (solution[j-1] <= cplex[j].getObjValue() * 0.999) {
+						if (ctx.outputLevel < 2) cout << j << " ";
+					} else if (cuts[j-1] == 2) {
 						// If cost is underestimated, create optimality cut
-						++OptCuts; status[j-1] = true;
+						++OptCuts;
 						expr_cut[j-1] = - var[0][j-1];
-						cplex[j].getDuals(TempArray, rng[j]);
-						for (int k=0; k < TempArray.getSize(); ++k)
-							expr_cut[j-1] += TempArray[k] * rng[j][k].getUB();
-						cplex[j].getReducedCosts(TempNumArray[j-1], var[j]);
-						
-						if (outputLevel < 2) cout << "o" << j << " ";
-					} else {
-						status[j-1] = false;
+						if (ctx.outputLevel < 2) cout << "o" << j << " ";
+					}
+					if (status[j-1])
+						expr_cut[j-1] += constant;
+				}
+				
+				// Upper bound if the subproblems were solved at the master solution and all are feasible
+				if (!(StabStep && (method == 1))) {
+					double total = cost;
+					for (int j=1; j <= nyears; ++j)
+						total += SubObj[j];
+					if (total < upper) {
+						upper = total;
+						if (method > 1) center = current;
 					}
 				}
 				
-				if (OptCuts+FeasCuts > 0) {
+				if (StabStep && (method == 1)) {
+					// In-out: move the core point towards the master solution. If no cut removes the
+					// master solution, the remaining iterations use the master solution directly
+					for (int i=0; i < ctx.IdxCap.size; ++i)
+						center[i] = 0.5 * (center[i] + current[i]);
+					if (Violated == 0)
+						stabilise = false;
+				} else if (StabStep && (method == 2) && (OptCuts+FeasCuts == 0)) {
+					// Trust region: the solution is optimal within the box. If the box limits it, the box
+					// is enlarged; otherwise it is also the solution of the master
+					if (binding)
+						radius *= 2;
+					else
+						stabilise = false;
+				}
+				
+				// An infeasible subproblem that only repeats cuts of the pool cannot be fixed
+				if (!StabStep && (OptCuts+FeasCuts == 0) && (RepCuts > 0)) {
+					repeated = true;
+				} else if (OptCuts+FeasCuts > 0) {
 					// Finalize cuts
 					vector<int> copied(nyears, 0);
-					for (int i=0; i < IdxCap.size; ++i) {
-						int year = IdxCap.year[i];
+					for (int i=0; i < ctx.IdxCap.size; ++i) {
+						int year = ctx.IdxCap.year[i];
 						if (status[year-1])
-							expr_cut[year-1] += TempNumArray[year-1][copied[year-1]] * var[0][nyears + i];
+							expr_cut[year-1] += TempNumArray[year][copied[year-1]] * var[0][nyears + i];
 						++copied[year-1];
 					}
 					
@@ -169,28 +1084,51 @@ void CPLEX::SolveIndividual(double *objective, const double events[], const bool
 							string constraintName = "Cut_y" + ToString<int>(j) + "_iter" + ToString<int>(iter);
 							MasterCuts[MasterCuts.getSize()-1].setName(constraintName.c_str());
 							model[0].add(MasterCuts[MasterCuts.getSize()-1]);
-						}
-						// Reset solver properties
-						if (cplex[j].getCplexStatus() != CPX_STAT_OPTIMAL) {
-							cplex[j].setParam(IloCplex::PreInd,1);
-							cplex[j].setParam(IloCplex::ScaInd,0);
-							cplex[j].setParam(IloCplex::RootAlg, IloCplex::Dual);
+							if (ctx.useCutPool) {
+								CutKey.push_back(keys[j-1]);
+								CutAge[keys[j-1]] = 0;
+							}
 						}
 					}
-				} else {
+				} else if (!StabStep) {
 					// Store solution if optimal solution found
+					converged = true;
 					StoreSolution();
 					if (saveDual)
 						StoreDualSolution();
 				}
 				
-				if (outputLevel < 2) {
-					if (OptCuts+FeasCuts == 0) cout << "No cuts - Optimal solution found!";
+				// Reset solver properties
+				for (int j=1; j <= nyears; ++j) {
+					if (cplex[j].getCplexStatus() != CPX_STAT_OPTIMAL) {
+						cplex[j].setParam(IloCplex::PreInd,1);
+						cplex[j].setParam(IloCplex::ScaInd,0);
+						cplex[j].setParam(IloCplex::RootAlg, IloCplex::Dual);
+					}
+				}
+				
+				// Convergence: iteration, lower and upper bounds, relative gap, cuts and stabilised step
+				double gap = (upper < 1.0e29) ? (upper - lower) / max(1.0, fabs(upper)) : 1;
+				vector<double> row(6);
+				row[0] = iter; row[1] = lower; row[2] = upper; row[3] = gap; row[4] = OptCuts + FeasCuts; row[5] = StabStep;
+				Convergence.push_back(row);
+				
+				if (ctx.outputLevel < 2) {
+					if (repeated) cout << "Repeated feasibility cuts!";
+					else if (converged) cout << "No cuts - Optimal solution found!";
 					cout << endl;
+					if (method > 0) {
+						cout << "\tLower: " << lower << "\tUpper: " << upper << "\tGap: " << 100 * gap << "%";
+						if (StabStep) cout << "\t(stabilised)";
+						cout << endl;
+					}
 				}
 			}
 			
-			if ((cplex[0].getCplexStatus() == CPX_STAT_OPTIMAL) && (iter <= MAX_ITER)) {
+			if ((ctx.outputLevel < 2) && (method > 0))
+				cout << "\tBenders iterations: " << iter << " (" << StabSteps << " stabilised, " << ctx.BendersMethod << ")" << endl;
+			
+			if ((cplex[0].getCplexStatus() == CPX_STAT_OPTIMAL) && converged) {
 				optimal = true;
 				objective[0] = cplex[0].getObjValue();
 			} else {
@@ -198,35 +1136,43 @@ void CPLEX::SolveIndividual(double *objective, const double events[], const bool
 			}
 		}
 		
-		if (!optimal) {
+		if (Pruned) {
+			// Dominated by the front, the objectives are the bounds when it was stopped
+			if (ctx.outputLevel < 2)
+				cout << "\tDominated by the front, evaluation stopped" << endl;
+		} else if (!optimal) {
 			// Solution not found, return very large values
 			if (iter > MAX_ITER)
 				cout << "\tReached max. number of iterations!" << endl;
 			else
 				cout << "\tProblem infeasible!" << endl;
-			for (int i=0; i < Nobj; ++i)
+			for (int i=0; i < ctx.Nobj; ++i)
 				objective[i] = 1.0e30;
 		} else {
-			if (outputLevel < 2)
+			if (ctx.outputLevel < 2)
 				cout << "\tCost: " << objective[0] << endl;
 			
+			// The events change the problems, so the basis kept for other individuals is this one
+			if (ctx.NbasisCache > 0)
+				GetBasis(BaseBasis);
+			
 			// Sustainability metrics
-			vector<double> emissions = SumByRow(solution, IdxEm);
-			for (int i=0; i < SustObj.size(); ++i) {
+			vector<double> emissions = SumByRow(solution, ctx.IdxEm);
+			for (int i=0; i < ctx.SustObj.size(); ++i) {
 				// Print results on screen
-				if (outputLevel < 2) {
-					if (SustObj[i] == "EmCO2" || SustObj[i] == "CO2") {
-						cout << "\t" << SustObj[i] << ": ";
-						cout << EmissionIndex(solution, IdxEm.start + SLength[0]*i);
+				if (ctx.outputLevel < 2) {
+					if (ctx.SustObj[i] == "EmCO2" || ctx.SustObj[i] == "CO2") {
+						cout << "\t" << ctx.SustObj[i] << ": ";
+						cout << EmissionIndex(ctx, solution, ctx.IdxEm.start + ctx.SLength[0]*i);
 						cout << " (Sum: " << emissions[i] << ")" << endl;
 					} else {
-						cout << "\t" << SustObj[i] << ": " << emissions[i] << endl;
+						cout << "\t" << ctx.SustObj[i] << ": " << emissions[i] << endl;
 					}
 				}
 				
 				// Return sustainability metric
-				if (SustObj[i] == "EmCO2" || SustObj[i] == "CO2")
-					objective[1+i] = EmissionIndex(solution, IdxEm.start + SLength[0]*i);
+				if (ctx.SustObj[i] == "EmCO2" || ctx.SustObj[i] == "CO2")
+					objective[1+i] = EmissionIndex(ctx, solution, ctx.IdxEm.start + ctx.SLength[0]*i);
 				else
 					objective[1+i] = emissions[i];
 			}
@@ -236,88 +1182,147 @@ void CPLEX::SolveIndividual(double *objective, const double events[], const bool
 				*returnString = "";
 				
 				// Write total emissions
-				for (int i=0; i < SustMet.size(); ++i)
+				for (int i=0; i < ctx.SustMet.size(); ++i)
 					*returnString += "," + ToString<double>(emissions[i]);
 				
 				// Write investments
-				/*vector<double> Investments = SumByRow(solution, IdxInv);
+				/*vector<double> Investments = SumByRow(solution, ctx.IdxInv);
 				for (int j=0; j < Investments.size(); ++j)
 					*returnString += "," + ToString<double>(Investments[j]);*/
 			}
 			
 			// Resiliency calculations
-			if (Nevents > 0) {
+			if (ctx.Nevents > 0) {
 				bool ResilOptimal = true;
-				double ResilObj[Nevents], resiliency = 0;
-				int startPos = IdxCap.size * (Nevents + 1);
+				double ResilObj[ctx.Nevents], resiliency = 0;
 				
 				// Evaluate all the events and obtain operating cost
-				if (outputLevel < 2) cout << "- Solving resiliency..." << endl;
+				if (ctx.outputLevel < 2) cout << "- Solving resiliency..." << endl;
 				
 				// Initialize operational cost
-				for (int event=1; event <= Nevents; ++event)
+				for (int event=1; event <= ctx.Nevents; ++event)
 					ResilObj[event-1] = 0;
 				
-				for (int j=1; j <= nyears; ++j) {
-					if (events[startPos + (j-1) * (Nevents+1)] == 1) {
-						// If Benders is used, the operational cost is already available
-						if (!useBenders) {
-							// Solve subproblem
-							CapacityConstraints(events, 0, 0);
-							cplex[j].solve();
-						}
-						
-						for (int event=1; event <= Nevents; ++event)
-							if (events[startPos + (j-1) * (Nevents+1) + event] == 1)
-								ResilObj[event-1] -= cplex[j].getObjValue();
-					}
+				// If Benders is used, the capacities and operational cost are already available
+				if (!ctx.useBenders)
+					CapacityConstraints(events, 0, 0);
+				
+				if (ctx.useScreening) {
+					ScreenPrepare();
+					Screened = 0;
 				}
 				
-				for (int event=1; event <= Nevents; ++event) {
-					bool current_feasible = true;
-					
-					// Store capacities as constraints
-					CapacityConstraints(events, event, 0);
-					double years_changed[nyears];
-					
-					for (int j=1; (j <= nyears) & (current_feasible); ++j) {
-						if (events[startPos + (j-1) * (Nevents+1) + event] == 1) {
+				if (ctx.BendersThreads > 1) {
+					// Each thread solves all the events of one year (the subproblems have their own environment)
+					if (!PruneFront.empty() && DominatedResiliency(objective, 0, true))
+						Pruned = true;
+					else
+						SolveEventsParallel(events, ResilObj, ResilOptimal);
+				} else {
+					double BaseObj[nyears + 1];
+					for (int j=1; j <= nyears; ++j) {
+						if (events.Affects(0, j)) {
 							// Solve subproblem
-							cplex[j].solve();
-							years_changed[j-1] = 1;
+							if (!ctx.useBenders)
+								cplex[j].solve();
+							BaseObj[j] = cplex[j].getObjValue();
+							if (ctx.useScreening)
+								ScreenBase(j);
 							
-							if (cplex[j].getCplexStatus() != CPX_STAT_OPTIMAL) {
-								// If subproblem is infeasible
-								ResilObj[event-1] = 1.0e10;
-								ResilOptimal = false;
-								current_feasible = false;
-								if (outputLevel < 2) cout << "\t\tEv: " << event << "\tYr: " << j << "\tInfeasible!" << endl;
-							} else {
-								// If subproblem is feasible
-								ResilObj[event-1] += cplex[j].getObjValue();
+							for (int event=1; event <= ctx.Nevents; ++event)
+								if (events.Affects(event, j))
+									ResilObj[event-1] -= BaseObj[j];
+						}
+					}
+					
+					// Years where each event cannot change the cost, and events with the largest estimated
+					// impact first (so that dominated individuals are found sooner)
+					vector< vector<int> > screened(ctx.Nevents + 1, vector<int>(nyears + 1, 0));
+					vector< pair<double, int> > order;
+					for (int event=1; event <= ctx.Nevents; ++event) {
+						double impact = 0, estimate;
+						if (ctx.useScreening) {
+							for (int j=1; j <= nyears; ++j) {
+								if (events.Affects(event, j)) {
+									screened[event][j] = NonBinding(events, event, j, estimate);
+									impact += estimate;
+								}
 							}
-						} else {
-							years_changed[j-1] = 0;
 						}
+						order.push_back(make_pair(-impact, event));
 					}
+					if (ctx.useScreening)
+						sort(order.begin(), order.end());
 					
-					if (current_feasible) {
-						StoreDualSolution(event, years_changed);
+					double spent = 0;
+					for (unsigned int e = 0; e < order.size(); ++e) {
+						int event = order[e].second;
+						bool current_feasible = true;
+						
+						// Stop if the objectives with the events solved so far are dominated
+						if (!PruneFront.empty() && DominatedResiliency(objective, spent, ResilOptimal)) {
+							Pruned = true;
+							break;
+						}
+						
+						// Reduce the capacities affected by the event
+						CapacityConstraints(events, event, 0);
+						double years_changed[nyears];
+						
+						for (int j=1; (j <= nyears) & (current_feasible); ++j) {
+							if (events.Affects(event, j) && screened[event][j]) {
+								// The base solution is still optimal
+								ResilObj[event-1] += BaseObj[j];
+								years_changed[j-1] = 0;
+								++Screened;
+							} else if (events.Affects(event, j)) {
+								// Solve subproblem
+								cplex[j].solve();
+								years_changed[j-1] = 1;
+								
+								if (cplex[j].getCplexStatus() != CPX_STAT_OPTIMAL) {
+									// If subproblem is infeasible
+									ResilObj[event-1] = 1.0e10;
+									ResilOptimal = false;
+									current_feasible = false;
+									if (ctx.outputLevel < 2) cout << "\t\tEv: " << event << "\tYr: " << j << "\tInfeasible!" << endl;
+								} else {
+									// If subproblem is feasible
+									ResilObj[event-1] += cplex[j].getObjValue();
+								}
+							} else {
+								years_changed[j-1] = 0;
+							}
+						}
+						
+						if (current_feasible) {
+							StoreDualSolution(event, years_changed);
+							spent += ResilObj[event-1];
+						}
+						
+						// Restore the capacities for the next event
+						ResetCapacity(events, event, 0);
 					}
 				}
 				
-				if (ResilOptimal) {
+				if (ctx.useScreening && (ctx.outputLevel < 2))
+					cout << "\tEvents screened: " << Screened << " (event, year) pairs not solved" << endl;
+				
+				if (Pruned) {
+					if (ctx.outputLevel < 2)
+						cout << "\tDominated by the front, resiliency stopped" << endl;
+				} else if (ResilOptimal) {
 					// Calculate resiliency results
-					for (int j = 0; j < Nevents; ++j) {
+					for (int j = 0; j < ctx.Nevents; ++j) {
 						resiliency += ResilObj[j];
-						if (outputLevel < 2) cout << "\t\tEv: " << j+1 << "\tCost: " << ResilObj[j] << endl;
+						if (ctx.outputLevel < 2) cout << "\t\tEv: " << j+1 << "\tCost: " << ResilObj[j] << endl;
 					}
-					objective[SustObj.size() + 1] = resiliency / Nevents;
-					if (outputLevel < 2)
-						cout << "\tResiliency: " << resiliency / Nevents << endl;
+					objective[ctx.SustObj.size() + 1] = resiliency / ctx.Nevents;
+					if (ctx.outputLevel < 2)
+						cout << "\tResiliency: " << resiliency / ctx.Nevents << endl;
 				} else {
-					objective[SustObj.size() + 1] = 1.0e9;
-					if (outputLevel < 2)
+					objective[ctx.SustObj.size() + 1] = 1.0e9;
+					if (ctx.outputLevel < 2)
 						cout << "\tResiliency infeasible!" << endl;
 				}
 				
@@ -325,7 +1330,7 @@ void CPLEX::SolveIndividual(double *objective, const double events[], const bool
 				if (returnString != NULL) {
 					string tempString = "";
 					
-					for (int event=0; event < Nevents; ++event)
+					for (int event=0; event < ctx.Nevents; ++event)
 						tempString += "," + ToString<double>(ResilObj[event]);
 					
 					*returnString = tempString + *returnString;
@@ -333,10 +1338,12 @@ void CPLEX::SolveIndividual(double *objective, const double events[], const bool
 			}
 		}
 		
-		// Erase cuts created with Benders
-		if (useBenders) {
-			model[0].remove(MasterCuts);
-			MasterCuts.endElements();
+		// Erase cuts created with Benders (or only the old ones if they are kept in a pool)
+		if (ctx.useBenders) {
+			if (ctx.useCutPool)
+				PurgeCuts(optimal);
+			else
+				ClearCuts();
 		}
 		
 	} catch (IloException& e) {
@@ -348,11 +1355,11 @@ void CPLEX::SolveIndividual(double *objective, const double events[], const bool
 
 // Store complete solution vector
 void CPLEX::StoreSolution(bool onlymaster) {
-	int nyears = SLength[0];
+	int nyears = ctx.SLength[0];
 	solution.clear();
 	
 	try {
-		if (!useBenders || onlymaster) {
+		if (!ctx.useBenders || onlymaster) {
 			// Only one file
 			cplex[0].getValues(solution, var[0]);
 		} else {
@@ -366,48 +1373,48 @@ void CPLEX::StoreSolution(bool onlymaster) {
 			position[0] = nyears;
 			
 			// Recover capacities
-			for (int j = 0; j < IdxCap.size; ++j) {
-				int tempYear = IdxCap.year[j];
+			for (int j = 0; j < ctx.IdxCap.size; ++j) {
+				int tempYear = ctx.IdxCap.year[j];
 				solution.add(TempNumArray[0][position[0]]);
 				++position[0]; ++position[tempYear];
 			}
 			
 			// Recover investments
-			for (int j = 0; j < IdxInv.size; ++j) {
+			for (int j = 0; j < ctx.IdxInv.size; ++j) {
 				solution.add(TempNumArray[0][position[0]]);
 				++position[0];
 			}
 			
 			// Recover sustainability metrics
-			for (int j = 0; j < IdxEm.size; ++j) {
-				int tempYear = IdxArc.year[j];
+			for (int j = 0; j < ctx.IdxEm.size; ++j) {
+				int tempYear = ctx.IdxArc.year[j];
 				solution.add(TempNumArray[tempYear][position[tempYear]]);
 				++position[tempYear];
 			}
 			
 			// Recover reserve margin
-			for (int j = 0; j < IdxRm.size; ++j) {
+			for (int j = 0; j < ctx.IdxRm.size; ++j) {
 				solution.add(TempNumArray[0][position[0]]);
 				++position[0];
 			}
 			
 			// Recover flows
-			for (int j = 0; j < IdxArc.size; ++j) {
-				int tempYear = IdxArc.year[j];
+			for (int j = 0; j < ctx.IdxArc.size; ++j) {
+				int tempYear = ctx.IdxArc.year[j];
 				solution.add(TempNumArray[tempYear][position[tempYear]]);
 				++position[tempYear];
 			}
 			
 			// Recover unserved demand
-			for (int j = 0; j < IdxUd.size; ++j) {
-				int tempYear = IdxUd.year[j];
+			for (int j = 0; j < ctx.IdxUd.size; ++j) {
+				int tempYear = ctx.IdxUd.year[j];
 				solution.add(TempNumArray[tempYear][position[tempYear]]);
 				++position[tempYear];
 			}
 			
 			// Recover DC angles
-			for (int j = 0; j < IdxDc.size; ++j) {
-				int tempYear = IdxDc.year[j];
+			for (int j = 0; j < ctx.IdxDc.size; ++j) {
+				int tempYear = ctx.IdxDc.year[j];
 				solution.add(TempNumArray[tempYear][position[tempYear]]);
 				++position[tempYear];
 			}
@@ -421,29 +1428,29 @@ void CPLEX::StoreSolution(bool onlymaster) {
 
 // Store dual solution vector
 void CPLEX::StoreDualSolution() {
-	int nyears = SLength[0];
-	for (int i=0; i<Nevents; ++i)
+	int nyears = ctx.SLength[0];
+	for (int i=0; i<ctx.Nevents; ++i)
 		dualsolution[i].clear();
 	
 	try {
-		if (!useBenders) {
+		if (!ctx.useBenders) {
 			// Only one file
 			cplex[0].getDuals(TempArray, rng[0]);
-			int start = IdxEm.size + IdxRm.size;
-			for (int i=0; i < IdxNode.size; ++i)
+			int start = ctx.IdxEm.size + ctx.IdxRm.size;
+			for (int i=0; i < ctx.IdxNode.size; ++i)
 				dualsolution[0].add(TempArray[start +i]);
 		} else {
 			// Multiple files (Benders decomposition)
 			for (int i=1; i <= nyears; ++i)
-				cplex[i].getDuals(TempNumArray[i-1], rng[i]);
+				cplex[i].getDuals(DualArray[i], rng[i]);
 			
 			// The following array keeps track of what has already been copied
-			vector<int> position(nyears, SustMet.size());
+			vector<int> position(nyears, ctx.SustMet.size());
 			
 			// Recover nodal duals
-			for (int j = 0; j < IdxNode.size; ++j) {
-				int tempYear = IdxNode.year[j];
-				dualsolution[0].add(TempNumArray[tempYear-1][position[tempYear-1]]);
+			for (int j = 0; j < ctx.IdxNode.size; ++j) {
+				int tempYear = ctx.IdxNode.year[j];
+				dualsolution[0].add(DualArray[tempYear][position[tempYear-1]]);
 				++position[tempYear-1];
 			}
 		}
@@ -455,25 +1462,25 @@ void CPLEX::StoreDualSolution() {
 }
 
 void CPLEX::StoreDualSolution(int event, double *years) {
-	int nyears = SLength[0];
+	int nyears = ctx.SLength[0];
 	
 	try {
 		for (int i=1; i <= nyears; ++i) {
 			if (years[i-1] == 1)
-				cplex[i].getDuals(TempNumArray[i-1], rng[i]);
+				cplex[i].getDuals(DualArray[i], rng[i]);
 			else
-				TempNumArray[i-1].clear();
+				DualArray[i].clear();
 		}
 		
 		// The following array keeps track of what has already been copied
-		vector<int> position(nyears, SustMet.size());
+		vector<int> position(nyears, ctx.SustMet.size());
 		int globalposition = 0;
 		
 		// Recover nodal duals
-		for (int j = 0; j < IdxNode.size; ++j) {
-			int tempYear = IdxNode.year[j];
+		for (int j = 0; j < ctx.IdxNode.size; ++j) {
+			int tempYear = ctx.IdxNode.year[j];
 			if (years[tempYear-1] == 1) {
-				dualsolution[event].add(TempNumArray[tempYear-1][position[tempYear-1]]);
+				dualsolution[event].add(DualArray[tempYear][position[tempYear-1]]);
 			} else {
 				dualsolution[event].add(dualsolution[0][globalposition]);
 			}
@@ -486,27 +1493,33 @@ void CPLEX::StoreDualSolution(int event, double *years) {
 	}
 }
 
-// Function called by the NSGA-II method. It takes the minimum investement (x) and calculates the metrics (objective)
-void CPLEX::SolveProblem(double *x, double *objective, const double events[]) {
-	// Start of investment variables
-	int inv = IdxCap.size;
-	if (useBenders) inv += SLength[0];
-	
-	for (int i = 0; i < IdxNsga.size; ++i)
-		var[0][inv + i].setLB(x[i]);
+// Function called by the NSGA-II method. It takes the minimum investement (x) and calculates the metrics (objective),
+// and the string of detailed metrics if requested (same as in postnsga)
+void CPLEX::SolveProblem(double *x, double *objective, const EventStore& events, string *returnString) {
+	ApplyMinInv(x);
 	
 	// Solve problem
-	SolveIndividual(objective, events);
+	SolveIndividual(objective, events, false, returnString);
 }
 
 // Apply minimum investments to the master problem
 void CPLEX::ApplyMinInv(double *x) {
 	// Start of investment variables
-	int inv = IdxCap.size;
-	if (useBenders) inv += SLength[0];
+	int inv = ctx.IdxCap.size;
+	if (ctx.useBenders) inv += ctx.SLength[0];
 	
-	for (int i = 0; i < IdxNsga.size; ++i) {
-		var[0][inv + i].setLB(x[i]);
+	try {
+		vector<int> cols(ctx.IdxNsga.size);
+		vector<double> lb(x, x + ctx.IdxNsga.size), ub(ctx.IdxNsga.size);
+		for (int i = 0; i < ctx.IdxNsga.size; ++i) {
+			cols[i] = inv + i;
+			ub[i] = VarUB[0][inv + i];
+		}
+		ApplyBounds(0, cols, lb, ub);
+	} catch (IloException& e) {
+		cerr << "Concert exception caught: " << e << endl;
+	} catch (...) {
+		cerr << "Unknown exception caught" << endl;
 	}
 }
 
@@ -527,17 +1540,36 @@ vector<string> CPLEX::SolutionDualString(int event) {
 }
 
 // Apply capacities from master to subproblems
-void CPLEX::CapacityConstraints(const double events[], const int event, const int offset) {
-	int nyears = SLength[0];
+void CPLEX::CapacityConstraints(const EventStore& events, const int event, const int offset) {
+	int nyears = ctx.SLength[0];
 	
 	try {
-		vector<int> copied(nyears, 0);
-		for (int i=0; i < IdxCap.size; ++i) {
-			int year = IdxCap.year[i];
-			IloNum rhs = events[i * (Nevents+1) + event] * solution[offset + i];
-			var[year][copied[year-1]].setUB(rhs);
-			++copied[year-1];
+		// Find the position of each capacity within its subproblem
+		if (CapPos.size() != ctx.IdxCap.size) {
+			vector<int> copied(nyears, 0);
+			CapPos.resize(ctx.IdxCap.size);
+			for (int i=0; i < ctx.IdxCap.size; ++i)
+				CapPos[i] = copied[ctx.IdxCap.year[i]-1]++;
+		}
+		
+		vector< vector<int> > cols(nyears + 1);
+		vector< vector<double> > ub(nyears + 1);
+		if (event == 0) {
+			// Base case: all the capacities
+			for (int i=0; i < ctx.IdxCap.size; ++i) {
+				cols[ctx.IdxCap.year[i]].push_back(CapPos[i]);
+				ub[ctx.IdxCap.year[i]].push_back(solution[offset + i]);
+			}
+		} else {
+			// Events: only the capacities that change
+			for (int k = events.start[event]; k < events.start[event+1]; ++k) {
+				int i = events.cap[k];
+				cols[events.year[k]].push_back(CapPos[i]);
+				ub[events.year[k]].push_back(events.factor[k] * solution[offset + i]);
+			}
 		}
+		for (int j=1; j <= nyears; ++j)
+			ApplyUpper(j, cols[j], ub[j]);
 	} catch (IloException& e) {
 		cerr << "Concert exception caught: " << e << endl;
 	} catch (...) {
@@ -545,13 +1577,74 @@ void CPLEX::CapacityConstraints(const double events[], const int event, const in
 	}
 }
 
-double EmissionIndex(const IloNumArray& v, const int start) {
+// Restore the capacities changed by an event to their base value
+void CPLEX::ResetCapacity(const EventStore& events, const int event, const int offset) {
+	int nyears = ctx.SLength[0];
+	
+	try {
+		vector< vector<int> > cols(nyears + 1);
+		vector< vector<double> > ub(nyears + 1);
+		for (int k = events.start[event]; k < events.start[event+1]; ++k) {
+			int i = events.cap[k];
+			cols[events.year[k]].push_back(CapPos[i]);
+			ub[events.year[k]].push_back(solution[offset + i]);
+		}
+		for (int j=1; j <= nyears; ++j)
+			ApplyUpper(j, cols[j], ub[j]);
+	} catch (IloException& e) {
+		cerr << "Concert exception caught: " << e << endl;
+	} catch (...) {
+		cerr << "Unknown exception caught" << endl;
+	}
+}
+
+// Keeps the bounds of the variables of model j after loading it
+void CPLEX::StoreBounds(const int j) {
+	VarLB[j].resize(var[j].getSize());
+	VarUB[j].resize(var[j].getSize());
+	for (int c=0; c < var[j].getSize(); ++c) {
+		VarLB[j][c] = var[j][c].getLB();
+		VarUB[j][c] = var[j][c].getUB();
+	}
+}
+
+// Changes the bounds of the columns 'cols' of model j. Only the ones that differ from the bounds
+// applied before are sent to Cplex, all of them with a single call
+void CPLEX::ApplyBounds(const int j, const vector<int>& cols, const vector<double>& lb, const vector<double>& ub) {
+	vector<int> changed;
+	for (unsigned int n = 0; n < cols.size(); ++n)
+		if ((lb[n] != VarLB[j][cols[n]]) || (ub[n] != VarUB[j][cols[n]]))
+			changed.push_back(n);
+	if (changed.empty())
+		return;
+	
+	IloNumVarArray vars(SubEnv[j], changed.size());
+	IloNumArray lower(SubEnv[j], changed.size()), upper(SubEnv[j], changed.size());
+	for (unsigned int n = 0; n < changed.size(); ++n) {
+		int c = cols[changed[n]];
+		vars[n] = var[j][c];
+		lower[n] = VarLB[j][c] = lb[changed[n]];
+		upper[n] = VarUB[j][c] = ub[changed[n]];
+	}
+	vars.setBounds(lower, upper);
+	vars.end(); lower.end(); upper.end();
+}
+
+// Same as above, changing only the upper bounds
+void CPLEX::ApplyUpper(const int j, const vector<int>& cols, const vector<double>& ub) {
+	vector<double> lb(cols.size());
+	for (unsigned int n = 0; n < cols.size(); ++n)
+		lb[n] = VarLB[j][cols[n]];
+	ApplyBounds(j, cols, lb, ub);
+}
+
+double EmissionIndex(const ModelContext& ctx, const IloNumArray& v, const int start) {
 	// This function calculates an emission index
 	double em_zero = v[start], max = v[start], min = v[start], reduction = 0.01 * v[start], increase = 0.01, sum = 0;
 	int first_year = 5, j = 0;
 	vector<double> index(0);
 	
-	for (int i = 1; i < SLength[0]; ++i) {
+	for (int i = 1; i < ctx.SLength[0]; ++i) {
 		// max: worst case scenario emissions
 		max = max * (1 + increase);
 		// min: best case scenario emissions
@@ -12,11 +12,25 @@ using namespace std;
 #include <fstream>
 #include <string>
 #include <vector>
+#include <map>
 #include "global.h"
+#include "mps.h"
+#include "event.h"
 #include <ilcplex/ilocplex.h>
 
+// Basis of the master and the subproblems (status of each column and row), which is used
+// to start the solution of an individual from the one of a similar individual
+struct Basis {
+	vector< vector<int> > cols, rows;
+	// Benders cuts whose rows follow the rows of the master (keys in the pool)
+	vector<string> cuts;
+};
+
 // Declares a structure to store and manipulate problem information
 struct CPLEX {
+	// Model state of the case being solved
+	ModelContext& ctx;
+	
 	IloEnv env;
 	IloArray<IloModel> model;
 	IloArray<IloCplex> cplex;
@@ -24,26 +38,115 @@ struct CPLEX {
 	IloArray<IloNumVarArray> var;
 	IloArray<IloRangeArray> rng;
 	IloNumArray solution, TempArray;
-	IloArray<IloNumArray> dualsolution, TempNumArray;
+	IloArray<IloNumArray> dualsolution, TempNumArray, DualArray;
+	
+	// Environment of each problem. Subproblems have their own one if they are solved in parallel
+	vector<IloEnv> SubEnv;
 	
 	// Variable to store temporary master cuts
 	IloRangeArray MasterCuts;
 	
-	CPLEX(): env(), model(env, 0), cplex(env, 0), obj(env, 0), var(env, 0), rng(env, 0), solution(env, 0), dualsolution(env, 0),
-		MasterCuts(env, 0), TempArray(env, 0), TempNumArray(env, 0) {};
+	// Pool of cuts kept between individuals (UseCutPool): key of each cut in MasterCuts and
+	// number of individuals since each key was last binding
+	vector<string> CutKey;
+	map<string, int> CutAge;
+	
+	// Benders: cost of each subproblem in the last iteration, cuts for all feasible subproblems (in-out
+	// steps) and convergence of the last solution (iteration, lower and upper bound, gap, cuts, stabilised)
+	vector<double> SubObj;
+	bool AlwaysCut;
+	vector< vector<double> > Convergence;
+	
+	// Simplex iterations of each problem (for reporting)
+	vector<long> SimplexIter;
+	
+	// Objectives of the front used to stop the evaluation of dominated individuals (empty to solve
+	// all of them completely), and whether the last individual was stopped
+	vector< vector<double> > PruneFront;
+	bool Pruned;
+	
+	// Resiliency solved in parallel: events of the task, and cost and nodal duals of each event and year
+	const EventStore* TaskEvents;
+	vector< vector<double> > EventCost;
+	vector< vector< vector<double> > > EventDuals;
+	
+	// Event screening (ScreenEvents): rows of each capacity in its subproblem with their coefficients
+	// (ScreenCap false if the capacity cannot be screened), whether the rows of each year are known,
+	// and capacity, row slacks and row duals of the base case
+	vector< vector<int> > ScreenRows;
+	vector< vector<double> > ScreenCoef;
+	vector<int> ScreenCap, ScreenYear;
+	vector<double> BaseCap;
+	vector< vector<double> > BaseSlack, BaseRowDual;
+	int Screened;
+	
+	CPLEX(ModelContext& context): ctx(context), env(), model(env, 0), cplex(env, 0), obj(env, 0), var(env, 0), rng(env, 0), solution(env, 0), TempArray(env, 0),
+		dualsolution(env, 0), TempNumArray(env, 0), DualArray(env, 0), MasterCuts(env, 0), AlwaysCut(false), Pruned(false), TaskEvents(NULL), Screened(0) {};
 	
 	~CPLEX() {
 		// Remove optimization elements from memory
-		TempNumArray.end(); TempArray.end(); MasterCuts.end();
+		DualArray.end(); TempNumArray.end(); TempArray.end(); MasterCuts.end();
 		dualsolution.end(); solution.end(); rng.end(); var.end(); obj.end(); model.end(); cplex.end();
+		for (unsigned int i = 1; i < SubEnv.size(); ++i)
+			if (ctx.BendersThreads > 1) SubEnv[i].end();
 		env.end();
 	};
 	
-	// Loads the problem from MPS files into memory
-	void LoadProblem();
+	// Loads the problem from MPS files, the binary model or the blocks built in memory
+	void LoadProblem(const vector<LPBlock>* blocks = NULL);
+	void LoadBlock(const int i, const LPBlock& block);
+	void LoadBlock(const int i, const LPBlock& block, const LPBlock& structure);
+	
+	// Changes the loaded problems to the values of new blocks with the same structure (warm start)
+	bool UpdateProblem(const vector<LPBlock>& current, const vector<LPBlock>& blocks);
+	int UpdateBlock(const int i, const LPBlock& current, const LPBlock& block, const LPBlock& structure);
+	void ClearCuts();
+	
+	// Cut pool: key of the cut of subproblem j and removal of the cuts that are not binding
+	string CutSignature(const int j, const int type, const double constant);
+	void PurgeCuts(const bool optimal);
+	
+	// Stabilised Benders: master restricted to a box around 'center', or closest point to 'center'
+	// whose cost in the master is below 'level'
+	bool SolveTrustRegion(const vector<double>& center, const double radius, bool& binding);
+	bool SolveLevel(const vector<double>& center, const double level, double& cost);
+	
+	// Runs 'task' for each year in 'years', using several threads (BendersThreads). The
+	// value returned by each task is stored in 'result', in the same order as 'years'
+	void RunParallel(const vector<int>& years, int (CPLEX::*task)(const int), vector<int>& result);
+	
+	// Solves Benders subproblem j and gets the information for a cut (0 none, 1 feasibility, 2 optimality, -1 error)
+	int BendersTask(const int j);
+	
+	// Simplex iterations since the last call, and basis of all the problems
+	long Iterations();
+	void GetBasis(Basis& basis);
+	void SetBasis(const Basis& basis);
+	IloRangeArray BasisRows(const int i);
+	vector<string> BasisCuts();
+	
+	// Basis after the solution of the base case, before the events (basiscache)
+	Basis BaseBasis;
+	
+	// Checks if an individual with objectives of at least 'bound' (or a resiliency cost of at least
+	// 'cost' over all the events) is dominated by PruneFront
+	bool Dominated(const vector<double>& bound);
+	bool DominatedResiliency(double *objective, const double cost, const bool feasible);
+	
+	// Solves the events that affect year j, and all the events with several threads (BendersThreads)
+	int ResiliencyTask(const int j);
+	void SolveEventsParallel(const EventStore& events, double *ResilObj, bool& ResilOptimal);
+	
+	// Event screening: rows of the capacities of year j, base case of year j, and whether an event
+	// cannot change the cost of year j (the base solution is still feasible). 'impact' is an estimate
+	// of the increase of cost with the duals of the base case
+	void ScreenPrepare();
+	void ScreenStructure(const int j);
+	void ScreenBase(const int j);
+	bool NonBinding(const EventStore& events, const int event, const int j, double& impact);
 	
 	// Solves current model
-	void SolveIndividual(double *objective, const double events[], const bool saveDual = false, string *returnString = NULL);
+	void SolveIndividual(double *objective, const EventStore& events, const bool saveDual = false, string *returnString = NULL);
 	
 	// Store complete solution vector
 	void StoreSolution(bool onlymaster=false);
@@ -51,7 +154,7 @@ struct CPLEX {
 	void StoreDualSolution(int event, double *years);
 	
 	// Function called by the NSGA-II method. It takes the minimum investement (x) and calculates the metrics (objective)
-	void SolveProblem(double *x, double *objective, const double events[]);
+	void SolveProblem(double *x, double *objective, const EventStore& events, string *returnString = NULL);
 	
 	// Apply minimum investments to the master problem
 	void ApplyMinInv(double *x);
@@ -60,12 +163,23 @@ struct CPLEX {
 	vector<string> SolutionString();
 	vector<string> SolutionDualString(int event);
 	
-	// Apply capacities from master to subproblems
-	void CapacityConstraints(const double events[], const int event, const int offset);
+	// Apply capacities from master to subproblems (only the capacities that change for events)
+	void CapacityConstraints(const EventStore& events, const int event, const int offset);
+	void ResetCapacity(const EventStore& events, const int event, const int offset);
+	
+	// Position of each capacity (IdxCap) within the variables of its subproblem
+	vector<int> CapPos;
+	
+	// Bounds of the variables of each model as last sent to Cplex. Bound changes go through
+	// ApplyBounds, which only sends the values that differ (in a single call for each model)
+	vector< vector<double> > VarLB, VarUB;
+	void StoreBounds(const int j);
+	void ApplyBounds(const int j, const vector<int>& cols, const vector<double>& lb, const vector<double>& ub);
+	void ApplyUpper(const int j, const vector<int>& cols, const vector<double>& ub);
 };
 
 // Metrics
-double EmissionIndex(const IloNumArray& v, const int start);
+double EmissionIndex(const ModelContext& ctx, const IloNumArray& v, const int start);
 vector<double> SumByRow(const IloNumArray& v, Index Idx);
 
 #endif  // _SOLVER_H_
@@ -13,12 +13,12 @@ using namespace std;
 #include "global.h"
 
 // Converts a string like 'y1m2' into the appropriate 'Step' (vector of integers)
-Step Str2Step(const string& mystep) {
+Step Str2Step(const ModelContext& ctx, const string& mystep) {
 	Step output(0);
 	size_t found;
 	int zeros = 0;
-	for (unsigned int k = 0; k < SName.size(); k++) {
-		found = mystep.find(SName[k]);
+	for (unsigned int k = 0; k < ctx.SName.size(); k++) {
+		found = mystep.find(ctx.SName[k]);
 		if (found!=string::npos) {
 			output.push_back(atoi(mystep.substr(found+1).c_str()));
 		} else {
@@ -26,37 +26,37 @@ Step Str2Step(const string& mystep) {
 			++zeros;
 		}
 	}
-	if (zeros == SName.size()) {
+	if (zeros == ctx.SName.size()) {
 		output[0] = -1;
 	}
 	return output;
 }
 
 // Converts the appropriate 'Step' (vector of integers) into its corresponding string (such as 'y1m2')
-string Step2Str(const Step& mystep) {
+string Step2Str(const ModelContext& ctx, const Step& mystep) {
 	string output = "";
 	char printstep[3];
-	for (unsigned int k=0; k < SName.size(); k++) {
+	for (unsigned int k=0; k < ctx.SName.size(); k++) {
 		if (mystep[k] > 0) {
-			output += SName.substr(k,1) + ToString<int>(mystep[k]);
+			output += ctx.SName.substr(k,1) + ToString<int>(mystep[k]);
 		}
 	}
 	return output;
 }
 
 // Given a 'Step', finds the next one
-Step NextStep(const Step& mystep) {
+Step NextStep(const ModelContext& ctx, const Step& mystep) {
 	Step output = mystep;
 	bool summed = false;
 	int kk;
-	for (unsigned int k = SLength.size(); k>0; k--) {
+	for (unsigned int k = ctx.SLength.size(); k>0; k--) {
 		kk = k-1;
 		if ((output[kk] > 0) && (!summed)) {
 			output[kk] += 1;
 			summed = true;
 		}
-		if ((output[kk] > SLength[kk]) && (kk>0)) {
-			output[kk] -= SLength[kk];
+		if ((output[kk] > ctx.SLength[kk]) && (kk>0)) {
+			output[kk] -= ctx.SLength[kk];
 			output[kk-1] += 1;
 		}
 	};
@@ -64,12 +64,12 @@ Step NextStep(const Step& mystep) {
 }
 
 // Sum two 'Step' variables
-Step StepSum(const Step& a, const Step& b) {
+Step StepSum(const ModelContext& ctx, const Step& a, const Step& b) {
 	Step output = a;
-	for (int k = SLength.size()-1; k >= 0; --k) {
+	for (int k = ctx.SLength.size()-1; k >= 0; --k) {
 		output[k] += b[k];
-		while ((output[k] > SLength[k]) && (k>0)) {
-			output[k] -= SLength[k];
+		while ((output[k] > ctx.SLength[k]) && (k>0)) {
+			output[k] -= ctx.SLength[k];
 			output[k-1] += 1;
 		}
 	};
@@ -78,13 +78,18 @@ Step StepSum(const Step& a, const Step& b) {
 
 // Given a 'Step', it determines the column position (for reading properties).
 // It goes like this: 'const' 'y1' 'y1m1' 'y1m1h1' 'y1m1h2' ... 'y1m2' etc.
-int Step2Pos(const Step& mystep) {
+int Step2Pos(const ModelContext& ctx, const Step& mystep) {
+	return Step2Pos(mystep, ctx.SLength);
+}
+
+// Same as above, but using the lengths given in 'length' instead of the ones in the context
+int Step2Pos(const Step& mystep, const Step& length) {
 	int output = 0, temp_size;
 	unsigned int j = 0;
 	while ((j < mystep.size()) && (mystep[j] !=0)) {
 		temp_size = 1;
 		for (unsigned int k = mystep.size()-1; k > j; k--) {
-			temp_size = temp_size * SLength[k] + 1;
+			temp_size = temp_size * length[k] + 1;
 		}
 		output += (mystep[j]-1) * temp_size + 1;
 		j++;
@@ -94,33 +99,100 @@ int Step2Pos(const Step& mystep) {
 
 // Given a 'Step', it determines the column position (for writing output).
 // It goes like this: 'y1' 'y2' ... 'y1m1' 'y1m2' ... 'y1m1h1' 'y1m1h2' etc.
-int Step2Col(const Step& mystep) {
+int Step2Col(const ModelContext& ctx, const Step& mystep) {
 	int output = 1, temp, num = 0;
 	for (int i = mystep.size()-2; i >= 0 ; --i) {
 		if (mystep[i+1] != 0) {
-			output = 1 + output * SLength[i];
+			output = 1 + output * ctx.SLength[i];
 			num++;
 		}
 	}
 	output--;
 	for (unsigned int i = 0; i <= num; ++i) {
 		temp = 1;
-		for (unsigned int k = i+1; k <= num; ++k) temp = temp * SLength[k];
+		for (unsigned int k = i+1; k <= num; ++k) temp = temp * ctx.SLength[k];
 		output += (mystep[i] - 1) * temp;
 	}
 	return output;
 }
 
-// Given a 'Step', find its length in hours, which is stored in the global variable StepHours
-string Step2Hours(const Step& mystep) {
+// Given a 'Step', find its length in hours, which is stored in StepHours
+string Step2Hours(const ModelContext& ctx, const Step& mystep) {
 	int idx;
-	if (mystep[SName.size()-1] != 0) {
-		idx = (SName.size() -1) + (mystep[SName.size()-1] - 1);
+	if (mystep[ctx.SName.size()-1] != 0) {
+		idx = (ctx.SName.size() -1) + (mystep[ctx.SName.size()-1] - 1);
 	} else {
 		idx = -1;
-		for (int j=0; j<SName.size()-1; ++j) {
+		for (int j=0; j<ctx.SName.size()-1; ++j) {
 			if (mystep[j] != 0) ++idx;
 		}
 	}
-	return StepHours[idx];
+	if (ctx.PeriodWeight.size() == 0)
+		return ctx.StepHours[idx];
+	return ToString<double>(atof(ctx.StepHours[idx].c_str()) * StepWeight(ctx, mystep));
+}
+
+// Given a 'Step', find how many periods it represents when representative periods are used
+double StepWeight(const ModelContext& ctx, const Step& mystep) {
+	int p = ctx.SName.size() - 2;
+	if ((ctx.PeriodWeight.size() == 0) || (p < 1) || (mystep[p] == 0))
+		return 1;
+	int group = 0;
+	for (int k = 0; k < p; ++k)
+		group = group * ctx.SLength[k] + (mystep[k] - 1);
+	return ctx.PeriodWeight[group * ctx.SLength[p] + (mystep[p] - 1)];
+}
+
+// Given a 'Step', finds the next one within the same representative period. The last
+// step of the period is followed by the first one and a period itself is followed by the
+// same period, so that storage is cyclic
+Step CyclicStep(const ModelContext& ctx, const Step& mystep) {
+	int p = ctx.SName.size() - 2;
+	if ((p < 1) || (mystep[p] == 0))
+		return NextStep(ctx, mystep);
+	if (mystep[p+1] == 0)
+		return mystep;
+	
+	Step output = NextStep(ctx, mystep);
+	
+	bool same = true;
+	for (int k = 0; k <= p; ++k)
+		same = same && (output[k] == mystep[k]);
+	if (!same) {
+		output = mystep;
+		for (unsigned int k = p+1; k < output.size(); ++k)
+			if (output[k] != 0) output[k] = 1;
+	}
+	return output;
+}
+
+// Given a year, lists the steps of its periods in order (all the levels up to the periods)
+vector<Step> YearPeriods(const ModelContext& ctx, const int year, const Step& length) {
+	int p = ctx.SName.size() - 2;
+	vector<Step> output(0);
+	Step period(ctx.SName.size(), 0);
+	period[0] = year;
+	for (int k = 1; k <= p; ++k) period[k] = 1;
+	
+	while ((p >= 1) && (period[0] == year)) {
+		output.push_back(period);
+		int k = p;
+		while ((k > 0) && (period[k] == length[k])) {
+			period[k] = 1;
+			--k;
+		}
+		++period[k];
+	}
+	return output;
+}
+
+// Given an original period, finds its representative period in the assignment of its group
+Step RepPeriod(const ModelContext& ctx, const Step& period) {
+	int p = ctx.SName.size() - 2;
+	int group = 0;
+	for (int k = 0; k < p; ++k)
+		group = group * ctx.SLength[k] + (period[k] - 1);
+	Step output = period;
+	output[p] = ctx.PeriodRep[group * ctx.SFullLength[p] + (period[p] - 1)] + 1;
+	return output;
 }
@@ -9,27 +9,43 @@
 
 typedef vector<int> Step;
 
+struct ModelContext;
+
 // Converts a string like 'y1m2' into the appropriate 'Step' (vector of integers)
-Step Str2Step(const string& mystep);
+Step Str2Step(const ModelContext& ctx, const string& mystep);
 
 // Converts the appropriate 'Step' (vector of integers) into its corresponding string (such as 'y1m2')
-string Step2Str(const Step& mystep);
+string Step2Str(const ModelContext& ctx, const Step& mystep);
 
 // Given a 'Step', finds the next one
-Step NextStep(const Step& mystep);
+Step NextStep(const ModelContext& ctx, const Step& mystep);
 
 // Sum two 'Step' variables
-Step StepSum(const Step& a, const Step& b);
+Step StepSum(const ModelContext& ctx, const Step& a, const Step& b);
 
 // Given a 'Step', it determines the column position (for reading properties).
 // It goes like this: 'const' 'y1' 'y1m1' 'y1m1h1' 'y1m1h2' ... 'y1m2' etc.
-int Step2Pos(const Step& mystep);
+int Step2Pos(const ModelContext& ctx, const Step& mystep);
+int Step2Pos(const Step& mystep, const Step& length);
 
 // Given a 'Step', it determines the column position (for writing output).
 // It goes like this: 'const' 'y1' 'y2' ... 'y1m1' 'y1m2' ... 'y1m1h1' 'y1m1h2' etc.
-int Step2Col(const Step& mystep);
+int Step2Col(const ModelContext& ctx, const Step& mystep);
+
+// Given a 'Step', find its length in hours, which is stored in StepHours
+string Step2Hours(const ModelContext& ctx, const Step& mystep);
+
+// Given a 'Step', find how many periods it represents when representative periods are used
+double StepWeight(const ModelContext& ctx, const Step& mystep);
+
+// Given a 'Step', finds the next one within the same representative period (cyclic)
+Step CyclicStep(const ModelContext& ctx, const Step& mystep);
+
+// Steps of the periods of a year (the level before the last one) for the given lengths: the
+// original periods with SFullLength or the representative periods with SLength
+vector<Step> YearPeriods(const ModelContext& ctx, const int year, const Step& length);
 
-// Given a 'Step', find its length in hours, which is stored in the global variable StepHours
-string Step2Hours(const Step& mystep);
+// Given an original period, finds the representative period that stands for it
+Step RepPeriod(const ModelContext& ctx, const Step& period);
 
 #endif  // _STEP_H_
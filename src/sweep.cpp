@@ -0,0 +1,215 @@
+// --------------------------------------------------------------
+//    NETSCORE Version 2
+//    sweep.cpp - Solving a table of parameter variants with the same optimization model
+//    2009-2011 (c) Eduardo Ibanez
+// --------------------------------------------------------------
+
+using namespace std;
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include "netscore.h"
+#include "solver.h"
+#include <sys/stat.h>
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+// Parameters that multiply model coefficients (costs and limits). Their effect on the problems is
+// linear, so it is measured once with a second build and applied to the values of each variant
+const char* LinearParams[] = {"OpCostScale", "InvCostScale", "LimitScale"};
+const int NumLinear = 3;
+
+double& LinearValue(ModelContext& ctx, const string& name) {
+	if (name == "OpCostScale") return ctx.OpCostScale;
+	if (name == "InvCostScale") return ctx.InvCostScale;
+	return ctx.LimitScale;
+}
+
+// True if the problems of both contexts have the same variables (indices) and are set up in the same way by the solver
+bool SameSetup(const ModelContext& a, const ModelContext& b) {
+	if ((a.SLength != b.SLength) || (a.Nevents != b.Nevents) || (a.Nobj != b.Nobj) || (a.SustObj != b.SustObj) || (a.SustMet != b.SustMet)
+		|| (a.useBenders != b.useBenders) || (a.BendersThreads != b.BendersThreads) || (a.BendersMethod != b.BendersMethod)
+		|| (a.IdxNames.Names != b.IdxNames.Names))
+		return false;
+	const Index* ia[] = {&a.IdxNode, &a.IdxUd, &a.IdxRm, &a.IdxArc, &a.IdxInv, &a.IdxCap, &a.IdxUb, &a.IdxEm, &a.IdxDc, &a.IdxNsga};
+	const Index* ib[] = {&b.IdxNode, &b.IdxUd, &b.IdxRm, &b.IdxArc, &b.IdxInv, &b.IdxCap, &b.IdxUb, &b.IdxEm, &b.IdxDc, &b.IdxNsga};
+	for (int i = 0; i < 10; ++i)
+		if ((ia[i]->start != ib[i]->start) || (ia[i]->size != ib[i]->size) || (ia[i]->position != ib[i]->position)
+			|| (ia[i]->column != ib[i]->column) || (ia[i]->year != ib[i]->year) || (ia[i]->name != ib[i]->name))
+			return false;
+	return true;
+}
+
+// Change of the values of the blocks per unit of a parameter ('probe' built with the parameter increased by 1).
+// Infinite values do not change. False if the structure is not the same
+bool LinearSlope(const vector<LPBlock>& base, const vector<LPBlock>& probe, vector<LPBlock>& slope) {
+	if (base.size() != probe.size()) return false;
+	slope = base;
+	for (unsigned int i = 0; i < base.size(); ++i) {
+		const LPBlock &a = base[i], &b = probe[i];
+		if (!a.SameStructure(b) || (a.templ != b.templ) || (a.rhs.size() != b.rhs.size()) || (a.obj.size() != b.obj.size()) || (a.value.size() != b.value.size()))
+			return false;
+		for (unsigned int k = 0; k < a.rhs.size(); ++k)
+			slope[i].rhs[k] = (fabs(a.rhs[k]) >= MPS_INF) ? 0 : b.rhs[k] - a.rhs[k];
+		for (unsigned int j = 0; j < a.obj.size(); ++j) {
+			slope[i].obj[j] = b.obj[j] - a.obj[j];
+			slope[i].lb[j] = (fabs(a.lb[j]) >= MPS_INF) ? 0 : b.lb[j] - a.lb[j];
+			slope[i].ub[j] = (fabs(a.ub[j]) >= MPS_INF) ? 0 : b.ub[j] - a.ub[j];
+		}
+		for (unsigned int n = 0; n < a.value.size(); ++n)
+			slope[i].value[n] = b.value[n] - a.value[n];
+	}
+	return true;
+}
+
+// Adds 'factor' times the slope to the values of the blocks
+void ApplySlope(vector<LPBlock>& blocks, const vector<LPBlock>& slope, const double factor) {
+	for (unsigned int i = 0; i < blocks.size(); ++i) {
+		for (unsigned int k = 0; k < blocks[i].rhs.size(); ++k)
+			blocks[i].rhs[k] += factor * slope[i].rhs[k];
+		for (unsigned int j = 0; j < blocks[i].obj.size(); ++j) {
+			blocks[i].obj[j] += factor * slope[i].obj[j];
+			blocks[i].lb[j] += factor * slope[i].lb[j];
+			blocks[i].ub[j] += factor * slope[i].ub[j];
+		}
+		for (unsigned int n = 0; n < blocks[i].value.size(); ++n)
+			blocks[i].value[n] += factor * slope[i].value[n];
+	}
+}
+
+int main () {
+	printHeader("sweep");
+
+	// Read global parameters
+	ModelContext ctx;
+	ReadParameters(ctx, "data/parameters.csv");
+
+	// Variants: the first row has the names of the parameters, the first column the name of the variant
+	MatrixStr Variants = ReadTable(ctx, "data/sweep.csv");
+	if (Variants.size() < 2) {
+		printError("error", "data/sweep.csv");
+		return 1;
+	}
+	VectorStr names(Variants[0].begin() + 1, Variants[0].end());
+
+	// Folder for the results
+	mkdir("./prepdata", 0777);
+
+	// Build the problems once, with the parameters of the case
+	vector<LPBlock> Base, Loaded;
+	EventStore baseEvents, events;
+	BuildModel(ctx, &Base, baseEvents, ctx.useDebugFiles);
+	SetIndexStarts(ctx);
+
+	// Slope of each linear parameter of the table (a second build with the parameter increased by 1)
+	vector<bool> linear(names.size(), false);
+	vector< vector<LPBlock> > Slope(names.size());
+	for (unsigned int k = 0; k < names.size(); ++k) {
+		for (int m = 0; m < NumLinear; ++m) {
+			if (names[k] != LinearParams[m]) continue;
+			ModelContext probe;
+			ReadParameters(probe, "data/parameters.csv", VectorStr(1, names[k]), VectorStr(1, ToString<double>(LinearValue(ctx, names[k]) + 1)));
+			vector<LPBlock> Probe;
+			EventStore probeEvents;
+			BuildModel(probe, &Probe, probeEvents, false);
+			linear[k] = LinearSlope(Base, Probe, Slope[k]);
+			if (!linear[k] && (ctx.outputLevel < 3))
+				cout << "\tWarning: '" << names[k] << "' changes the structure of the problem, variants are built again" << endl;
+		}
+	}
+
+	// Context of the loaded problems: the solver keeps a reference to it, and each variant is copied into it
+	ModelContext loaded;
+	loaded.Assign(ctx);
+	CPLEX* netplan = new CPLEX(loaded);
+	netplan->LoadProblem(&Base);
+	Loaded = Base;
+	events = baseEvents;
+
+	ofstream outfile("prepdata/sweep.csv");
+	outfile << Variants[0][0];
+	for (unsigned int k = 0; k < names.size(); ++k)
+		outfile << "," << names[k];
+	outfile << ",Cost";
+	for (int k = 0; k < ctx.SustObj.size(); ++k)
+		outfile << "," << ctx.SustObj[k];
+	if (ctx.Nevents > 0)
+		outfile << ",Resiliency";
+	outfile << endl;
+
+	for (unsigned int v = 1; v < Variants.size(); ++v) {
+		cout << "- Variant '" << Variants[v][0] << "' (" << v << " / " << Variants.size()-1 << ")" << endl;
+		VectorStr values(Variants[v].begin() + 1, Variants[v].end());
+		values.resize(names.size(), "");
+
+		// Empty cells keep the value of the case
+		VectorStr setNames(0), setValues(0);
+		bool derived = true;
+		for (unsigned int k = 0; k < names.size(); ++k) {
+			if (values[k] == "") continue;
+			setNames.push_back(names[k]);
+			setValues.push_back(values[k]);
+			derived = derived && linear[k];
+		}
+		ModelContext variant;
+		ReadParameters(variant, "data/parameters.csv", setNames, setValues);
+
+		vector<LPBlock> Blocks;
+		EventStore variantEvents;
+		if (derived) {
+			// Only costs and limits change: values of the case plus the slopes, the rest of the context is the case
+			Blocks = Base;
+			for (unsigned int k = 0; k < names.size(); ++k)
+				if (values[k] != "") ApplySlope(Blocks, Slope[k], LinearValue(variant, names[k]) - LinearValue(ctx, names[k]));
+			variantEvents = baseEvents;
+			double scale[NumLinear];
+			for (int m = 0; m < NumLinear; ++m)
+				scale[m] = LinearValue(variant, LinearParams[m]);
+			variant.Assign(ctx);
+			for (int m = 0; m < NumLinear; ++m)
+				LinearValue(variant, LinearParams[m]) = scale[m];
+		} else {
+			// Other parameters may change anything, the problems are built with the variant
+			BuildModel(variant, &Blocks, variantEvents, false);
+			SetIndexStarts(variant);
+		}
+
+		// Only the values that differ are changed in the loaded problems. The problems are loaded again
+		// only if the variables or the structure are not the same (e.g., a coefficient becomes zero)
+		if (SameSetup(loaded, variant) && netplan->UpdateProblem(Loaded, Blocks)) {
+			loaded.Assign(variant);
+		} else {
+			if (ctx.outputLevel < 3)
+				cout << "\tWarning: Variant changes the structure of the problem, reloading" << endl;
+			delete netplan;
+			loaded.Assign(variant);
+			netplan = new CPLEX(loaded);
+			netplan->LoadProblem(&Blocks);
+		}
+		Loaded.swap(Blocks);
+		events = variantEvents;
+
+		// Solve from the basis of the previous variant
+		double objective[loaded.Nobj];
+		netplan->SolveIndividual(objective, events);
+
+		outfile << Variants[v][0];
+		for (unsigned int k = 0; k < values.size(); ++k)
+			outfile << "," << values[k];
+		for (int k = 0; k < loaded.Nobj; ++k)
+			outfile << "," << objective[k];
+		outfile << endl;
+
+		cout << "\tValues returned:";
+		for (int k = 0; k < loaded.Nobj; ++k)
+			cout << " " << objective[k];
+		cout << endl;
+	}
+	outfile.close();
+	delete netplan;
+
+	printHeader("completed");
+	return 0;
+}
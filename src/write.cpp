@@ -15,7 +15,7 @@ using namespace std;
 #include "index.h"
 
 // Write data from an array of values
-void WriteOutput(const char* fileinput, Index& idx, vector<string>& values, const string& header) {
+void WriteOutput(const ModelContext& ctx, const char* fileinput, Index& idx, vector<string>& values, const string& header) {
 	// Open file
 	ofstream myfile;
 	myfile.open(fileinput);
@@ -32,31 +32,31 @@ void WriteOutput(const char* fileinput, Index& idx, vector<string>& values, cons
 			if (idx.column[i] < minimum) minimum = idx.column[i];
 		}
 		
-		Step start(SName.size(), 0), guide(SName.size());
+		Step start(ctx.SName.size(), 0), guide(ctx.SName.size());
 		bool got_start = false;
 		start[0] = 1;
-		for (unsigned int i=1; (i < SLength.size()) && !got_start; ++i) {
+		for (unsigned int i=1; (i < ctx.SLength.size()) && !got_start; ++i) {
 			start[i] = 1;
-			if (Step2Col(start) > minimum) {
+			if (Step2Col(ctx, start) > minimum) {
 				got_start = true;
 				start[i] = 0;
 			}
 		}
-		minimum = Step2Col(start);
+		minimum = Step2Col(ctx, start);
 		
 		// Write header description
 		myfile << header << endl;
 		
 		// Write line of time values
 		int k = -1;
-		for (unsigned int i=0; i < SLength.size(); ++i)
+		for (unsigned int i=0; i < ctx.SLength.size(); ++i)
 			k += start[i];
 		
 		guide = start;
-		while (Step2Col(start) <= maximum) {
-			myfile << "," << Step2Str(start);
-			start = NextStep(start);
-			if ((start > SLength) && (k < SLength.size()-1)) {
+		while (Step2Col(ctx, start) <= maximum) {
+			myfile << "," << Step2Str(ctx, start);
+			start = NextStep(ctx, start);
+			if ((start > ctx.SLength) && (k < ctx.SLength.size()-1)) {
 				k++;
 				guide[k] = 1;
 				start = guide;
@@ -70,7 +70,7 @@ void WriteOutput(const char* fileinput, Index& idx, vector<string>& values, cons
 			if (idx.position[i] != prevpos) {
 				for (int j = prevcol; j < maximum; ++j)
 					myfile << ",";
-				myfile << endl << idx.name[i];
+				myfile << endl << idx.Name(i);
 				for (int j = minimum; j < idx.column[i]; ++j)
 					myfile << ",";
 				prevpos = idx.position[i];
@@ -93,19 +93,19 @@ void WriteOutput(const char* fileinput, Index& idx, vector<string>& values, cons
 }
 
 // Write data output for a collection of nodes
-void WriteOutput(const char* fileinput, Index& idx, vector<Node>& Nodes, const string& selector, const string& header) {
+void WriteOutput(const ModelContext& ctx, const char* fileinput, Index& idx, vector<Node>& Nodes, const string& selector, const string& header) {
 	vector<string> values(0);
 	for (int i = 0; i < idx.size; ++i)
 		values.push_back(Nodes[i].Get(selector));
 		
-	WriteOutput(fileinput, idx, values, header);
+	WriteOutput(ctx, fileinput, idx, values, header);
 }
 
 // Write data output for a collection of arcs
-void WriteOutput(const char* fileinput, Index& idx, vector<Arc>& Arcs, const string& selector, const string& header) {
+void WriteOutput(const ModelContext& ctx, const char* fileinput, Index& idx, vector<Arc>& Arcs, const string& selector, const string& header) {
 	vector<string> values(0);
 	for (int i = 0; i < idx.size; ++i)
 		values.push_back(Arcs[i].Get(selector));
 	
-	WriteOutput(fileinput, idx, values, header);
+	WriteOutput(ctx, fileinput, idx, values, header);
 }